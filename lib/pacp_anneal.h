@@ -0,0 +1,287 @@
+// ==========================================
+// Filename: pacp_anneal.h
+// Optimization: Reusable Goal 1 / Goal 2 Annealing Engine (Hooks + Cooperative Stop)
+// ==========================================
+//
+// 原本整個退火迴圈寫在 optimizer.cpp 的 main 裡，只能「一個行程跑一個 L，找完就結束」。
+// 抽出成函式後:
+//   - optimizer 的行為不變 (同樣的重啟策略、Flash Check、30% / 60% 提早退出、輸出訊息)
+//   - 常駐的 pacpd 可以在同一個行程裡、多個執行緒上對不同 L 反覆呼叫
+// 與外界的互動都走 Hooks:
+//   found      : 找到 psl <= best 的候選 (回傳 true 表示是新的等價類且已存檔)
+//   hard_reset : HARD RESET 產生新種子時 (optimizer 用來覆寫 seed 檔)
+//   stop       : 每 4096 步問一次，回傳 true 就立刻結束 (pacpd 的預算 / 取消 / 讓出核心)
+// log 為 nullptr 時不輸出任何進度訊息。
+
+#ifndef PACP_ANNEAL_H
+#define PACP_ANNEAL_H
+
+#include "pacp_core.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace Anneal {
+
+    struct Options {
+        int target_val = 2;             // 奇數 2 (Goal 1)，偶數 0 (Goal 2)
+        bool fix_a = false;             // 只動 B (Legendre A)
+        long long target_count = 0;     // 達標後再找到這麼多筆就結束 (0: 不限)
+        unsigned seed = 0;
+        std::ostream* log = &std::cout;
+    };
+
+    struct Hooks {
+        std::function<bool(const Seq& A, const Seq& B, int psl)> found;
+        std::function<void(const Seq& A, const Seq& B)> hard_reset;
+        std::function<bool()> stop;
+    };
+
+    inline long long fast_cost(const Seq& A, const Seq& B, int L, int target_val, std::vector<int>& buf_a,
+                               std::vector<int>& buf_b) {
+        compute_acf(A, buf_a);
+        compute_acf(B, buf_b);
+        return calc_mse_cost(buf_a, buf_b, L, target_val);
+    }
+
+    inline void chaos_scramble(Seq& s, std::mt19937& rng) {
+        int L = s.size();
+        if (L == 0) return;
+        int shift1 = (L * 13) / 32; if (shift1 == 0) shift1 = 1;
+        rotate_seq_left(s, shift1);
+        std::uniform_int_distribution<int> dist_idx(0, L - 1);
+        int p1 = dist_idx(rng);
+        int p2 = dist_idx(rng);
+        if (p1 > p2) std::swap(p1, p2);
+        for (int i = p1; i <= p2; ++i) s[i] *= -1;
+        int shift2 = (L * 7) / 32; if (shift2 == 0) shift2 = 1;
+        rotate_seq_left(s, L - shift2);
+        int shift3 = (L * 5) / 32; if (shift3 == 0) shift3 = 1;
+        rotate_seq_left(s, shift3);
+    }
+
+    // 從 (A, B) 開始搜尋；回傳最後的 best PSL (A, B 為結束時的狀態)
+    inline int run(Seq& A, Seq& B, const Options& opt, const Hooks& hooks) {
+        static std::ostream null_out(nullptr);
+        std::ostream& out = opt.log ? *opt.log : null_out;
+
+        int L = A.size();
+        int target_val = opt.target_val;
+        bool fix_a = opt.fix_a;
+        long long target_count_arg = opt.target_count;
+        bool is_hard_mode = (target_val == 0);
+
+        // Aggressive Reset Strategy
+        int soft_retry_limit;
+        if (L < 40 || is_hard_mode) soft_retry_limit = 2;
+        else soft_retry_limit = 2 + (60 / L);
+
+        long long print_interval;
+        if (L < 60) print_interval = 50000;
+        else        print_interval = 5000;
+
+        double alpha_base = (L > 60) ? 10000.0 : 6000.0;
+        double alpha = 1.0 - (1.0 / (alpha_base * L));
+        int max_mutation_k = std::max(1, (int)(L * 0.05));
+        double cost_norm_factor = 1.0 / (double)L;
+
+        long long inner_max_steps = (L > 60) ? (300000LL * L) : (50000LL * L);
+        long long stagnation_limit = inner_max_steps / 4;
+
+        std::mt19937 rng(opt.seed);
+        std::uniform_real_distribution<double> dist_01(0.0, 1.0);
+        std::uniform_int_distribution<int> dist_idx(0, L - 1);
+        std::uniform_int_distribution<int> dist_rot(1, L - 1);
+
+        std::vector<int> acf_A(L), acf_B(L);
+        long long current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
+        int best_psl = 99999;
+        long long found_count = 0;
+
+        long long total_steps = 0;
+        int restart_count = 0;
+        int prev_global_best_psl = best_psl;
+        int global_stagnation_count = 0;
+
+        // 找到 psl <= best_psl 的候選: 交給 hook 判斷是否為新的等價類並存檔
+        // 回傳 0: 沒存 (重複)，1: 已存，2: 已存且刷新 best_psl
+        auto record = [&](int psl) {
+            if (!hooks.found || !hooks.found(A, B, psl)) return 0;
+            if (psl < best_psl) {
+                best_psl = psl;
+                prev_global_best_psl = best_psl;
+                found_count = 0;
+                return 2;
+            }
+            found_count++;
+            return 1;
+        };
+
+        while (target_count_arg == 0 || found_count < target_count_arg) {
+            if (hooks.stop && hooks.stop()) return best_psl;
+
+            // --- Restart Decision ---
+            if (total_steps > 0) {
+                restart_count++;
+
+                if (best_psl == prev_global_best_psl) global_stagnation_count++;
+                else { global_stagnation_count = 0; prev_global_best_psl = best_psl; }
+
+                bool do_hard_reset = false;
+                if (restart_count % soft_retry_limit == 0) do_hard_reset = true;
+                if (global_stagnation_count >= 2) do_hard_reset = true;
+
+                if (fix_a) {
+                    int r = dist_rot(rng);
+                    rotate_seq_left(A, r);
+                    for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
+                }
+                else if (do_hard_reset) {
+                    for(int i=0; i<L; ++i) A[i] = (dist_01(rng)<0.5)?1:-1;
+                    for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
+                    if (hooks.hard_reset) hooks.hard_reset(A, B);
+                    out << "\n[Restart] HARD RESET (New Seed Saved)" << std::endl;
+                }
+                else {
+                    chaos_scramble(A, rng);
+                    for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
+                    out << "\n[Restart] Chaos Scramble" << std::endl;
+                }
+                current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
+            }
+
+            double temp = 5.0;
+            int stuck_counter = 0;
+            int stuck_threshold = (L > 60) ? (6000 * L) : (3000 * L);
+
+            long long inner_step = 0;
+            int local_best_psl = 99999;
+            long long last_improvement_step = 0;
+
+            while (inner_step < inner_max_steps) {
+                inner_step++;
+                total_steps++;
+
+                if ((inner_step & 4095) == 0 && hooks.stop && hooks.stop()) return best_psl;
+
+                int protection_threshold = std::max(6, L / 5);
+                if (is_hard_mode) protection_threshold += 2;
+                bool is_promising = (local_best_psl <= protection_threshold);
+
+                if (!is_promising && (inner_step - last_improvement_step) > stagnation_limit) {
+                    out << " -> Stagnation (Stuck " << stagnation_limit << " steps)";
+                    break;
+                }
+
+                // 10% Flash Check
+                if (inner_step == (long long)(inner_max_steps * 0.1)) {
+                    int flash_limit = (int)(L * 0.6);
+                    int check_psl = calc_psl(acf_A, acf_B, L);
+
+                    if (check_psl < local_best_psl) {
+                        local_best_psl = check_psl;
+                        last_improvement_step = inner_step;
+                    }
+
+                    if (check_psl <= best_psl && record(check_psl) != 0) {
+                        out << "\n[Found Result] PSL=" << check_psl << " (Saved) @ Flash Check" << std::flush;
+                    }
+
+                    if (local_best_psl > flash_limit) {
+                        out << " -> Flash Exit (Bad Seed PSL=" << local_best_psl << ")";
+                        break;
+                    }
+                }
+
+                if (inner_step == (long long)(inner_max_steps * 0.3)) {
+                    int limit = (L > 80) ? (L / 2) : (L / 3);
+                    if (is_hard_mode) limit += 4;
+                    if (local_best_psl > std::max(10, limit)) { out << " -> Exit 30%"; break; }
+                }
+                if (inner_step == (long long)(inner_max_steps * 0.6)) {
+                    int limit = (L > 80) ? (L / 3) : (L / 4 + 4);
+                    if (is_hard_mode) limit += 6;
+                    if (local_best_psl > std::max(12, limit)) { out << " -> Exit 60%"; break; }
+                }
+
+                Seq old_A = A; Seq old_B = B; long long old_cost = current_cost;
+
+                bool is_rotate_move = (dist_01(rng) < 0.05);
+                if (is_rotate_move) {
+                    int rot_k = dist_rot(rng);
+                    if (fix_a) rotate_seq_left(A, rot_k);
+                    else {
+                        if (dist_01(rng) < 0.5) rotate_seq_left(A, rot_k);
+                        else rotate_seq_left(B, rot_k);
+                    }
+                } else {
+                    int current_k = 1;
+                    if (temp > 1.0 && max_mutation_k > 1) {
+                        std::uniform_int_distribution<int> dist_k(1, max_mutation_k);
+                        current_k = dist_k(rng);
+                    }
+                    for(int k=0; k<current_k; ++k) {
+                        bool flip_a = fix_a ? false : (dist_01(rng) < 0.5);
+                        if (flip_a) A[dist_idx(rng)] *= -1;
+                        else        B[dist_idx(rng)] *= -1;
+                    }
+                }
+
+                long long new_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
+
+                bool accept = false;
+                if (new_cost <= current_cost) accept = true;
+                else {
+                    double delta = (double)(new_cost - current_cost) * cost_norm_factor;
+                    if (dist_01(rng) < std::exp(-delta / temp)) accept = true;
+                }
+
+                if (accept) {
+                    current_cost = new_cost;
+                    if (new_cost < old_cost) stuck_counter = 0; else stuck_counter++;
+
+                    if (current_cost <= L) {
+                        int psl = calc_psl(acf_A, acf_B, L);
+
+                        if (psl < local_best_psl) {
+                            local_best_psl = psl;
+                            last_improvement_step = inner_step;
+                        }
+
+                        int saved = (psl <= best_psl) ? record(psl) : 0;
+                        if (saved != 0) {
+                            if (saved == 2) global_stagnation_count = 0;
+                            out << "\n[Found Result] PSL=" << psl << " (Saved) @ Total=" << total_steps << "   " << std::flush;
+
+                            bool goal_reached = false;
+                            if (best_psl == target_val) goal_reached = true;
+                            if (target_val == 0 && best_psl <= 2) { goal_reached = true; }
+
+                            if (goal_reached && (target_count_arg > 0 && found_count >= target_count_arg)) return best_psl;
+                        }
+                    }
+                } else {
+                    A = old_A; B = old_B; current_cost = old_cost; stuck_counter++;
+                }
+
+                temp *= alpha;
+
+                if (stuck_counter > stuck_threshold || temp < 0.001) {
+                    temp = 5.0; stuck_counter = 0;
+                    for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
+                    current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
+                }
+
+                if (inner_step % print_interval == 0) {
+                     out << "\r[Running] Step=" << inner_step << " | Best=" << best_psl << " | Loc=" << local_best_psl << "   " << std::flush;
+                }
+            }
+        }
+        return best_psl;
+    }
+}
+
+#endif
@@ -0,0 +1,416 @@
+// ==========================================
+// Filename: pacp_batch.h
+// Optimization: Parallel Batch Verification (mmap + Packed ACF Kernel) with CSV / JSON Verdicts
+// ==========================================
+//
+// pacpcheck / pqcpcheck 原本只能互動式一次貼一組，printf 整張彩色表；要檢查一個結果檔只能手動貼。
+// 這裡是兩個工具共用的非互動模式 (--batch):
+//   輸入   : 任意個檔案或 '-' (stdin)，文字檔任何方言 (PacpResults::parse_text，另外接受互動式的 "A B")
+//            或 PACPRES1 二進位檔；沒有給檔案時讀 stdin
+//   計算   : 所有 pair 收集成 Item 後在執行緒池上平行跑 Verify::Kernel (packed XOR + popcount)
+//   輸出   : 每組一行 CSV 或 JSON Lines (依輸入順序)，verdict 由各工具自己決定
+//   統計   : verdict / 類別 / L / PSL / peaks 直方圖，文字版寫 stderr，--summary FILE 另存 JSON
+// 標頭行 (L=..,PSL=..,Count=..)、註解與壞行不輸出，只計入 skipped。
+
+#ifndef PACP_BATCH_H
+#define PACP_BATCH_H
+
+#include "pacp_verify.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace BatchCheck {
+
+    // 由各工具提供: 依 profile 與 |S(L/2)| (奇數 L 為 0) 給出 verdict 字串 (需為字串常數)
+    using VerdictFn = const char* (*)(const Verify::Profile& p, int mid);
+
+    struct Options {
+        std::vector<std::string> inputs;   // 空: stdin
+        bool json = false;
+        bool header = true;                // CSV 標頭列
+        bool quiet = false;                // 不寫 stderr 統計
+        std::string out;                   // 空或 "-": stdout
+        std::string summary;               // JSON 直方圖
+        int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        int zcz_min = 0;                   // 0: 每個 L 用 L/2 (同 classify)
+    };
+
+    inline const char* usage() {
+        return "--batch [--format csv|json] [--out FILE] [--summary FILE] [--threads N] [--zcz-min Z]\n"
+               "        [--no-header] [--quiet] [FILE|-]...";
+    }
+
+    // argv[first..] 是 --batch 之後的參數；錯誤訊息寫到 err
+    inline bool parse_args(int argc, char* argv[], int first, Options& o, std::string& err) {
+        for (int i = first; i < argc; ++i) {
+            std::string a = argv[i];
+            if (a == "--format" && i + 1 < argc) {
+                std::string f = argv[++i];
+                if (f != "csv" && f != "json") {
+                    err = "Unknown format: " + f + " (expected csv or json)";
+                    return false;
+                }
+                o.json = (f == "json");
+            }
+            else if (a == "--json") o.json = true;
+            else if (a == "--csv") o.json = false;
+            else if (a == "--out" && i + 1 < argc) o.out = argv[++i];
+            else if (a == "--summary" && i + 1 < argc) o.summary = argv[++i];
+            else if (a == "--threads" && i + 1 < argc) o.threads = std::max(1, std::atoi(argv[++i]));
+            else if (a == "--zcz-min" && i + 1 < argc) o.zcz_min = std::max(2, std::atoi(argv[++i]));
+            else if (a == "--no-header") o.header = false;
+            else if (a == "--quiet") o.quiet = true;
+            else if (a == "-" || a.compare(0, 2, "--") != 0) o.inputs.push_back(a);
+            else {
+                err = "Unknown option: " + a;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    namespace detail {
+
+        // 一組待檢查的 pair (文字行或二進位 record) 與其結果
+        struct Item {
+            uint32_t src = 0;
+            uint64_t line = 0;     // 文字: 行號 (1 起算)；二進位: record 序號 (1 起算)
+            const char* a = nullptr;
+            const char* b = nullptr;
+            const PacpResults::RecordView* bin = nullptr;
+            int L = 0;
+            int mid = 0;
+            uint64_t fp = 0;
+            Verify::Profile p;
+            const char* verdict = "";
+        };
+
+        struct Input {
+            std::string name;
+            std::unique_ptr<MappedFile> map;
+            std::unique_ptr<PacpResults::Reader> bin;
+            std::string buf;       // stdin 內容
+            std::vector<PacpResults::RecordView> views;
+        };
+
+        // parse_text 不認得時，再試互動式的 "A B" (空白分隔兩條 +/-)
+        inline bool parse_pair(const char* b, const char* e, PacpResults::TextRecord& t) {
+            if (PacpResults::parse_text(b, e, t, false)) return true;
+            while (b < e && PacpParse::is_blank(*b)) ++b;
+            const char* s = b;
+            while (s < e && !PacpParse::is_blank(*s)) ++s;
+            const char* c = s;
+            while (c < e && PacpParse::is_blank(*c)) ++c;
+            int L = (int)(s - b);
+            if (L == 0 || L > 0xFFFF || e - c != L || !PacpParse::is_pm(b, L) || !PacpParse::is_pm(c, L)) return false;
+            t.h = PacpResults::RecordHeader{};
+            t.h.tag = PacpResults::TAG_PAIR;
+            t.h.L = (uint16_t)L;
+            t.h.words = PacpResults::words_for(L);
+            t.a = b;
+            t.b = c;
+            return true;
+        }
+
+        inline bool read_stdin(std::string& buf) {
+            char tmp[1 << 16];
+            size_t n;
+            while ((n = std::fread(tmp, 1, sizeof(tmp), stdin)) > 0) buf.append(tmp, n);
+            return !std::ferror(stdin);
+        }
+
+        // 文字區段 -> Item (行號用 memchr 區段間的 '\n' 數累加)
+        inline size_t collect_text(uint32_t src, const char* data, size_t size, std::vector<Item>& items) {
+            size_t skipped = 0;
+            PacpParse::LineScanner lines(data, data + size);
+            const char* last = data;
+            uint64_t line = 1;
+            const char* b;
+            const char* e;
+            PacpResults::TextRecord t;
+            while (lines.next(b, e)) {
+                line += (uint64_t)std::count(last, b, '\n');
+                last = b;
+                if (!parse_pair(b, e, t)) {
+                    if (*b != '#') skipped++;
+                    continue;
+                }
+                Item it;
+                it.src = src;
+                it.line = line;
+                it.a = t.a;
+                it.b = t.b;
+                it.L = t.h.L;
+                items.push_back(it);
+            }
+            return skipped;
+        }
+
+        inline void evaluate(std::vector<Item>& items, int num_threads, int zcz_min, VerdictFn verdict) {
+            std::atomic<size_t> next(0);
+            const size_t BLOCK = 64;
+            auto worker = [&]() {
+                Verify::Kernel kernel;
+                std::vector<uint64_t> a, b;
+                for (size_t s = next.fetch_add(BLOCK); s < items.size(); s = next.fetch_add(BLOCK)) {
+                    size_t e = std::min(items.size(), s + BLOCK);
+                    for (size_t i = s; i < e; ++i) {
+                        Item& it = items[i];
+                        int L = it.L;
+                        const uint64_t* pa;
+                        const uint64_t* pb;
+                        if (it.bin) {
+                            pa = it.bin->a;
+                            pb = it.bin->b;
+                            it.fp = it.bin->h->fingerprint;
+                        } else {
+                            a.resize(PacpResults::words_for(L));
+                            b.resize(PacpResults::words_for(L));
+                            PacpParse::pack_pm(it.a, L, a.data());
+                            PacpParse::pack_pm(it.b, L, b.data());
+                            pa = a.data();
+                            pb = b.data();
+                            it.fp = PacpResults::canonical_fingerprint_chars(it.a, it.b, L);
+                        }
+                        it.p = kernel.classify(pa, pb, L, zcz_min > 0 ? zcz_min : std::max(2, L / 2));
+                        it.mid = (L % 2 == 0) ? std::abs(kernel.last_sum()[L / 2]) : 0;
+                        it.verdict = verdict(it.p, it.mid);
+                    }
+                }
+            };
+            num_threads = std::max(1, std::min<int>(num_threads, (int)((items.size() + BLOCK - 1) / BLOCK)));
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker);
+            for (auto& th : threads) th.join();
+        }
+
+        inline void class_names(uint32_t c, std::string& out) {
+            static const std::pair<uint32_t, const char*> NAMES[] = {
+                { Verify::ODD_OPT, "odd" }, { Verify::EVEN_OPT, "even" }, { Verify::PQCP, "pqcp" },
+                { Verify::NEAR, "near" }, { Verify::SZCP, "szcp" },
+            };
+            out.clear();
+            for (const auto& n : NAMES) {
+                if (!(c & n.first)) continue;
+                if (!out.empty()) out += '|';
+                out += n.second;
+            }
+        }
+
+        inline void json_escape(const std::string& s, std::string& out) {
+            for (char c : s) {
+                if (c == '"' || c == '\\') { out += '\\'; out += c; }
+                else if ((unsigned char)c < 0x20) {
+                    char u[8];
+                    std::snprintf(u, sizeof(u), "\\u%04x", (unsigned char)c);
+                    out += u;
+                }
+                else out += c;
+            }
+        }
+
+        // CSV 欄位: 含 ',' / '"' 的來源路徑要加引號
+        inline void csv_field(const std::string& s, std::string& out) {
+            if (s.find_first_of(",\"\n") == std::string::npos) {
+                out += s;
+                return;
+            }
+            out += '"';
+            for (char c : s) {
+                if (c == '"') out += '"';
+                out += c;
+            }
+            out += '"';
+        }
+
+        inline void format_item(const Item& it, const std::string& src, bool json, std::string& cls, std::string& out) {
+            char num[160];
+            class_names(it.p.classes, cls);
+            if (json) {
+                out += "{\"source\":\"";
+                json_escape(src, out);
+                std::snprintf(num, sizeof(num),
+                              "\",\"line\":%llu,\"L\":%d,\"psl\":%d,\"peaks\":%d,\"zcz\":%d,\"mid\":%d,\"classes\":\"",
+                              (unsigned long long)it.line, it.L, it.p.psl, it.p.peaks, it.p.zcz, it.mid);
+                out += num;
+                out += cls;
+                std::snprintf(num, sizeof(num), "\",\"verdict\":\"%s\",\"fingerprint\":\"%016llx\"}\n", it.verdict,
+                              (unsigned long long)it.fp);
+                out += num;
+            } else {
+                csv_field(src, out);
+                std::snprintf(num, sizeof(num), ",%llu,%d,%d,%d,%d,%d,", (unsigned long long)it.line, it.L, it.p.psl,
+                              it.p.peaks, it.p.zcz, it.mid);
+                out += num;
+                out += cls.empty() ? "-" : cls;
+                std::snprintf(num, sizeof(num), ",%s,%016llx\n", it.verdict, (unsigned long long)it.fp);
+                out += num;
+            }
+        }
+
+        struct Summary {
+            size_t pairs = 0, skipped = 0, distinct = 0;
+            std::map<std::string, size_t> verdicts, classes;
+            std::map<int, size_t> lengths, psl, peaks;
+        };
+
+        template <class K>
+        inline void json_hist(const char* name, const std::map<K, size_t>& h, std::string& out) {
+            out += "\"";
+            out += name;
+            out += "\":{";
+            bool first = true;
+            for (const auto& kv : h) {
+                if (!first) out += ',';
+                first = false;
+                std::string k;
+                if constexpr (std::is_same<K, std::string>::value) k = kv.first;
+                else k = std::to_string(kv.first);
+                out += "\"" + k + "\":" + std::to_string(kv.second);
+            }
+            out += "}";
+        }
+
+        template <class K>
+        inline void text_hist(const char* name, const std::map<K, size_t>& h) {
+            std::fprintf(stderr, "%s\n", name);
+            for (const auto& kv : h) {
+                std::string k;
+                if constexpr (std::is_same<K, std::string>::value) k = kv.first;
+                else k = std::to_string(kv.first);
+                std::fprintf(stderr, "  %-12s %zu\n", k.c_str(), kv.second);
+            }
+        }
+    }
+
+    // 回傳 process exit code: 0 成功，1 輸入 / 輸出錯誤
+    inline int run(const Options& opt, VerdictFn verdict) {
+        using namespace detail;
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<std::string> names = opt.inputs;
+        if (names.empty()) names.push_back("-");
+
+        // 1. 收集 (mmap / stdin 內容保持到輸出完成)
+        std::vector<Input> inputs(names.size());
+        std::vector<Item> items;
+        Summary sum;
+        for (size_t i = 0; i < names.size(); ++i) {
+            Input& in = inputs[i];
+            in.name = names[i] == "-" ? "<stdin>" : names[i];
+            if (names[i] == "-") {
+                if (!read_stdin(in.buf)) {
+                    std::fprintf(stderr, "[Error] Cannot read stdin\n");
+                    return 1;
+                }
+                sum.skipped += collect_text((uint32_t)i, in.buf.data(), in.buf.size(), items);
+                continue;
+            }
+            if (PacpResults::is_binary_file(names[i])) {
+                in.bin = std::make_unique<PacpResults::Reader>();
+                if (!in.bin->open(names[i])) {
+                    std::fprintf(stderr, "[Error] Cannot open %s\n", names[i].c_str());
+                    return 1;
+                }
+                in.bin->for_each([&](const PacpResults::RecordView& v) { in.views.push_back(v); });
+                for (size_t k = 0; k < in.views.size(); ++k) {
+                    Item it;
+                    it.src = (uint32_t)i;
+                    it.line = k + 1;
+                    it.bin = &in.views[k];
+                    it.L = in.views[k].h->L;
+                    items.push_back(it);
+                }
+                continue;
+            }
+            in.map = std::make_unique<MappedFile>();
+            if (!in.map->open(names[i])) {
+                std::fprintf(stderr, "[Error] Cannot open %s\n", names[i].c_str());
+                return 1;
+            }
+            sum.skipped += collect_text((uint32_t)i, in.map->data(), in.map->size(), items);
+        }
+
+        // 2. 平行驗證
+        evaluate(items, opt.threads, opt.zcz_min, verdict);
+
+        // 3. 依輸入順序輸出
+        std::FILE* out = stdout;
+        if (!opt.out.empty() && opt.out != "-") {
+            out = std::fopen(opt.out.c_str(), "wb");
+            if (!out) {
+                std::fprintf(stderr, "[Error] Cannot write %s\n", opt.out.c_str());
+                return 1;
+            }
+        }
+        std::string buf, cls;
+        if (!opt.json && opt.header) buf += "source,line,L,psl,peaks,zcz,mid,classes,verdict,fingerprint\n";
+        std::unordered_set<uint64_t> seen;
+        for (const Item& it : items) {
+            format_item(it, inputs[it.src].name, opt.json, cls, buf);
+            if (buf.size() >= (1 << 20)) {
+                std::fwrite(buf.data(), 1, buf.size(), out);
+                buf.clear();
+            }
+            sum.pairs++;
+            if (seen.insert(it.fp).second) sum.distinct++;
+            sum.verdicts[it.verdict]++;
+            sum.classes[cls.empty() ? "-" : cls]++;
+            sum.lengths[it.L]++;
+            sum.psl[it.p.psl]++;
+            sum.peaks[it.p.peaks]++;
+        }
+        std::fwrite(buf.data(), 1, buf.size(), out);
+        bool ok = std::fflush(out) == 0;
+        if (out != stdout) ok = (std::fclose(out) == 0) && ok;
+        if (!ok) {
+            std::fprintf(stderr, "[Error] Write failed: %s\n", opt.out.empty() ? "<stdout>" : opt.out.c_str());
+            return 1;
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        // 4. 統計
+        if (!opt.summary.empty()) {
+            std::string js = "{\"pairs\":" + std::to_string(sum.pairs) + ",\"distinct\":" + std::to_string(sum.distinct) +
+                             ",\"skipped\":" + std::to_string(sum.skipped) + ",";
+            json_hist("verdict", sum.verdicts, js);
+            js += ',';
+            json_hist("classes", sum.classes, js);
+            js += ',';
+            json_hist("L", sum.lengths, js);
+            js += ',';
+            json_hist("psl", sum.psl, js);
+            js += ',';
+            json_hist("peaks", sum.peaks, js);
+            js += "}\n";
+            std::FILE* f = std::fopen(opt.summary.c_str(), "wb");
+            if (!f || std::fwrite(js.data(), 1, js.size(), f) != js.size()) {
+                if (f) std::fclose(f);
+                std::fprintf(stderr, "[Error] Cannot write %s\n", opt.summary.c_str());
+                return 1;
+            }
+            std::fclose(f);
+        }
+        if (!opt.quiet) {
+            std::fprintf(stderr, "[Batch] %zu pairs (%zu distinct), %zu skipped lines, %zu inputs, %.3f s\n", sum.pairs,
+                         sum.distinct, sum.skipped, inputs.size(), sec);
+            text_hist("Verdict", sum.verdicts);
+            text_hist("Classes", sum.classes);
+            text_hist("L", sum.lengths);
+            text_hist("PSL", sum.psl);
+            text_hist("Peaks", sum.peaks);
+        }
+        return 0;
+    }
+}
+
+#endif
@@ -0,0 +1,143 @@
+// ==========================================
+// Filename: pacp_bitslice.h
+// Optimization: Bit-Sliced Periodic ACF (64 candidates per word)
+// ==========================================
+//
+// Layout: planes[i] 的第 t 個 bit = 第 t 個候選序列的第 i 個元素
+//         (bit=1 -> -1, bit=0 -> +1，與 int_to_seq 相同)
+// 週期自相關: rho(u) = L - 2 * popcount_lane( planes[k] XOR planes[(k+u)%L] )
+// 以 bit-serial 加法器逐 k 累加不一致數，整個 u 只需 O(L) 個 64-bit 指令。
+
+#ifndef PACP_BITSLICE_H
+#define PACP_BITSLICE_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace BitSlice {
+
+    constexpr int LANES = 64;
+    constexpr int MAX_L = 62;        // brute_force 以 1LL << L 列舉，這已是上限
+    constexpr int COUNTER_BITS = 7;  // 計數上限 127 >= MAX_L
+
+    // 第 t 個 lane 的 bit i (i < 6) 的樣式
+    constexpr uint64_t LANE_BIT[6] = {
+        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+
+    // 候選 base .. base+63 (base 為 64 的倍數) 的 bit-plane
+    inline void load_consecutive(uint64_t base, int L, uint64_t* planes) {
+        for (int i = 0; i < L; ++i) {
+            if (i < 6) planes[i] = LANE_BIT[i];
+            else planes[i] = ((base >> i) & 1ULL) ? ~0ULL : 0ULL;
+        }
+    }
+
+    // 低 6 bit (lane 編號) 的 popcount 恰為 w 的 lane 遮罩
+    inline uint64_t lane_weight_mask(int w) {
+        static const auto table = []() {
+            std::vector<uint64_t> t(7, 0);
+            for (int lane = 0; lane < LANES; ++lane) t[__builtin_popcount(lane)] |= (1ULL << lane);
+            return t;
+        }();
+        return (w >= 0 && w <= 6) ? table[w] : 0ULL;
+    }
+
+    // Lane-wise: counter >= K  (K 為常數, 由 MSB 往 LSB 比較)
+    inline uint64_t lanes_ge(const uint64_t* c, int K) {
+        if (K <= 0) return ~0ULL;
+        if (K >= (1 << COUNTER_BITS)) return 0ULL;
+        uint64_t gt = 0, eq = ~0ULL;
+        for (int k = COUNTER_BITS - 1; k >= 0; --k) {
+            if ((K >> k) & 1) eq &= c[k];
+            else { gt |= eq & c[k]; eq &= ~c[k]; }
+        }
+        return gt | eq;
+    }
+
+    // Lane-wise: counter <= K
+    inline uint64_t lanes_le(const uint64_t* c, int K) {
+        if (K < 0) return 0ULL;
+        if (K >= (1 << COUNTER_BITS) - 1) return ~0ULL;
+        uint64_t lt = 0, eq = ~0ULL;
+        for (int k = COUNTER_BITS - 1; k >= 0; --k) {
+            if ((K >> k) & 1) { lt |= eq & ~c[k]; eq &= c[k]; }
+            else eq &= ~c[k];
+        }
+        return lt | eq;
+    }
+
+    // int_to_seq 的 bit i (s[i]) 改放到 bit L-1-i: s[0] 在最高位
+    inline uint64_t msb_first(uint64_t bits, int L) {
+        uint64_t r = 0;
+        for (int i = 0; i < L; ++i) r |= ((bits >> i) & 1ULL) << (L - 1 - i);
+        return r;
+    }
+
+    // 與 get_canonical_repr 相同的等價類 (循環位移 + 取負)，但以整數表示:
+    // s[0] 放在最高位，故整數大小順序 == '+'/'-' 字串的字典序
+    inline uint64_t canonical_key(uint64_t bits, int L) {
+        uint64_t mask = (L >= 64) ? ~0ULL : ((1ULL << L) - 1);
+        uint64_t r = msb_first(bits, L);
+        uint64_t best = std::min(r, r ^ mask);
+        for (int k = 1; k < L; ++k) {
+            r = ((r << 1) | (r >> (L - 1))) & mask;
+            uint64_t cand = std::min(r, r ^ mask);
+            if (cand < best) best = cand;
+        }
+        return best;
+    }
+
+    // 同 canonical_key，另回傳穩定子大小 |Stab| (2L 個變換中把序列映回自己的個數)
+    // 軌道大小 = 2L / |Stab|
+    inline uint64_t canonical_key_stab(uint64_t bits, int L, int& stab) {
+        uint64_t mask = (L >= 64) ? ~0ULL : ((1ULL << L) - 1);
+        uint64_t r = msb_first(bits, L);
+        const uint64_t r0 = r;
+        uint64_t best = std::min(r, r ^ mask);
+        stab = 1 + ((r ^ mask) == r0);
+        for (int k = 1; k < L; ++k) {
+            r = ((r << 1) | (r >> (L - 1))) & mask;
+            stab += (r == r0) + ((r ^ mask) == r0);
+            uint64_t cand = std::min(r, r ^ mask);
+            if (cand < best) best = cand;
+        }
+        return best;
+    }
+
+    inline long long floor_div2(long long x) { return (x >= 0) ? (x / 2) : -((-x + 1) / 2); }
+
+    // 回傳所有 u = 1..L/2 都滿足 |acf_a[u] + rho_b(u)| <= bound 的 lane 遮罩
+    // acf_a 必須為週期 ACF (對稱, 故只需檢查一半)
+    inline uint64_t filter_periodic(const uint64_t* planes, int L, const int* acf_a, int bound, uint64_t alive) {
+        uint64_t cnt[COUNTER_BITS];
+        for (int u = 1; u <= L / 2 && alive; ++u) {
+            for (int k = 0; k < COUNTER_BITS; ++k) cnt[k] = 0;
+
+            int k_wrap = L - u;
+            for (int k = 0; k < L; ++k) {
+                uint64_t d = planes[k] ^ planes[(k < k_wrap) ? (k + u) : (k - k_wrap)];
+                // Ripple-carry: 只在有進位時往上
+                for (int b = 0; b < COUNTER_BITS && d; ++b) {
+                    uint64_t carry = cnt[b] & d;
+                    cnt[b] ^= d;
+                    d = carry;
+                }
+            }
+
+            // |acf_a + L - 2*cnt| <= bound  <=>  lo <= cnt <= hi
+            long long base = (long long)acf_a[u] + L;
+            long long lo = -floor_div2(-(base - bound)); // ceil
+            long long hi = floor_div2(base + bound);
+            if (lo > hi) return 0ULL;
+            int lo_i = (int)std::max(-1LL, std::min(lo, (long long)(1 << COUNTER_BITS)));
+            int hi_i = (int)std::max(-1LL, std::min(hi, (long long)(1 << COUNTER_BITS)));
+            alive &= lanes_ge(cnt, lo_i) & lanes_le(cnt, hi_i);
+        }
+        return alive;
+    }
+}
+
+#endif
@@ -0,0 +1,217 @@
+// ==========================================
+// Filename: pacp_canon_index.h
+// Optimization: Persistent Canonical Fingerprint Index (Sidecar, mmap)
+// ==========================================
+//
+// load_existing_results 每次啟動都重讀整個結果檔、每行兩次 get_canonical_repr。
+// 改成在結果檔旁邊放一個 sidecar: <results>.cidx
+//   Header  : magic、建立時結果檔開頭 (最多 4KB) 的長度與雜湊 (偵測檔案被換掉 / 改寫)
+//   Entries : 每筆 { fingerprint, 寫入後結果檔的大小 }，只會 append；最大的 source_end 即涵蓋範圍
+//             fingerprint == 0 保留給「只記涵蓋範圍」的紀錄 (尾端只有標頭 / 註解)，載入時不當成指紋
+// 啟動時 mmap 讀入指紋:
+//   - 結果檔大小 == 已涵蓋大小          -> 直接使用 (不碰結果檔)
+//   - 結果檔變大 (別的 worker 也在寫)   -> 只解析新增的尾端，補進 index
+//   - 結果檔變小 / 開頭被改 / index 壞掉 -> 整個重建
+// 指紋是 PacpResults::canonical_fingerprint (循環位移 x 取負，{A,B} 不分順序)。
+
+#ifndef PACP_CANON_INDEX_H
+#define PACP_CANON_INDEX_H
+
+#include "pacp_results.h"
+#include "pacp_mmap.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <sys/stat.h>
+
+class CanonIndex {
+public:
+    static constexpr char MAGIC[8] = { 'P', 'A', 'C', 'P', 'C', 'I', 'X', '1' };
+    static constexpr size_t HEAD_HASH_BYTES = 4096;
+
+    struct Header {
+        char magic[8];
+        uint64_t head_len;    // 建立 index 時結果檔前 min(size, 4KB) bytes
+        uint64_t head_hash;   // 上述 bytes 的雜湊 (append 不會改變)
+    };
+    struct Entry {
+        uint64_t fingerprint;
+        uint64_t source_end;  // 這筆寫入後結果檔的大小
+    };
+    static_assert(sizeof(Header) == 24, "Header must stay mmap-compatible");
+    static_assert(sizeof(Entry) == 16, "Entry must stay mmap-compatible");
+
+    static std::string index_path(const std::string& results_path) { return results_path + ".cidx"; }
+
+    ~CanonIndex() { close(); }
+
+    // 載入 (必要時補齊或重建) results_path 的 index；結果檔不存在時建立空 index
+    bool open(const std::string& results_path) {
+        close();
+        src_ = results_path;
+        idx_ = index_path(results_path);
+        seen_.clear();
+        rebuilt_ = false;
+        tail_records_ = 0;
+
+        uint64_t src_size = file_size(src_);
+        uint64_t covered = 0;
+        if (!load(src_size, covered)) {
+            rebuilt_ = true;
+            covered = 0;
+            seen_.clear();
+            if (!start_index(std::min<uint64_t>(src_size, HEAD_HASH_BYTES))) return false;
+        } else {
+            out_ = std::fopen(idx_.c_str(), "ab");
+            if (!out_) return false;
+        }
+        if (src_size > covered) tail_records_ = index_tail(covered, src_size);
+        std::fflush(out_);
+        return true;
+    }
+
+    bool contains(uint64_t fp) const { return seen_.count(fp) != 0; }
+
+    // 結果行已 append 到結果檔之後呼叫；回傳 false 表示已存在 (不寫入)
+    bool add(uint64_t fp) {
+        if (!remember(fp)) return false;
+        commit(fp);
+        sync();
+        return true;
+    }
+
+    // 非同步寫入時拆成三步: 搜尋端先 remember (只進記憶體)，
+    // 結果行真正寫進檔案後由 writer thread commit (先排隊)，整批寫完再 sync 一次寫進 sidecar
+    bool remember(uint64_t fp) { return seen_.insert(fp).second; }
+
+    void commit(uint64_t fp) { pending_.push_back(fp); }
+
+    // 排隊中的 entry 一次寫出: 整批只 stat 一次、fflush 一次
+    // (此時這批的結果行都已在結果檔裡，source_end 取目前大小即可涵蓋)
+    void sync() {
+        if (pending_.empty()) return;
+        if (out_) {
+            uint64_t end = file_size(src_);
+            for (uint64_t fp : pending_) {
+                Entry e{ fp, end };
+                std::fwrite(&e, sizeof(e), 1, out_);
+            }
+            std::fflush(out_);
+        }
+        pending_.clear();
+    }
+
+    // 給 ResultSink::BatchHook 用 (ctx = CanonIndex*)
+    static void sync_hook(void* self) { static_cast<CanonIndex*>(self)->sync(); }
+
+    size_t size() const { return seen_.size(); }
+    bool rebuilt() const { return rebuilt_; }
+    size_t tail_records() const { return tail_records_; }
+
+    void close() {
+        sync();
+        if (out_) std::fclose(out_);
+        out_ = nullptr;
+    }
+
+private:
+    std::string src_, idx_;
+    std::unordered_set<uint64_t> seen_;
+    std::vector<uint64_t> pending_;   // commit 過、尚未 sync 的指紋
+    std::FILE* out_ = nullptr;
+    bool rebuilt_ = false;
+    size_t tail_records_ = 0;
+
+    static uint64_t file_size(const std::string& path) {
+        struct stat st;
+        return (stat(path.c_str(), &st) == 0) ? (uint64_t)st.st_size : 0;
+    }
+
+    static uint64_t hash_bytes(const char* p, size_t n) {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= (unsigned char)p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    uint64_t head_hash(uint64_t n) const {
+        if (n == 0) return 0;
+        std::vector<char> buf(n);
+        std::FILE* f = std::fopen(src_.c_str(), "rb");
+        if (!f) return 0;
+        size_t got = std::fread(buf.data(), 1, n, f);
+        std::fclose(f);
+        return hash_bytes(buf.data(), got);
+    }
+
+    // 讀入既有 index；失效時回傳 false
+    bool load(uint64_t src_size, uint64_t& covered) {
+        MappedFile m;
+        if (!m.open(idx_) || m.size() < sizeof(Header)) return false;
+        const Header* h = m.as<Header>();
+        if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+        covered = 0;
+        size_t n = (m.size() - sizeof(Header)) / sizeof(Entry);
+        const Entry* e = reinterpret_cast<const Entry*>(m.data() + sizeof(Header));
+        seen_.reserve(n * 2);
+        for (size_t i = 0; i < n; ++i) {
+            if (e[i].fingerprint != 0) seen_.insert(e[i].fingerprint);   // 0: 只記涵蓋範圍
+            if (e[i].source_end > covered) covered = e[i].source_end;
+        }
+        if ((m.size() - sizeof(Header)) % sizeof(Entry) != 0) return false;   // 寫到一半
+        if (covered > src_size) return false;                                  // 結果檔被截短
+        if (h->head_len > src_size || head_hash(h->head_len) != h->head_hash) return false;
+        return true;
+    }
+
+    bool start_index(uint64_t head_bytes) {
+        out_ = std::fopen(idx_.c_str(), "wb");
+        if (!out_) return false;
+        Header h;
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.head_len = head_bytes;
+        h.head_hash = head_hash(head_bytes);
+        std::fwrite(&h, sizeof(h), 1, out_);
+        // 涵蓋範圍由 entries 的 source_end 決定；整檔由 index_tail 補上
+        return true;
+    }
+
+    // 解析結果檔 [from, to) 的完整行，補進 index
+    size_t index_tail(uint64_t from, uint64_t to) {
+        MappedFile m;
+        if (!m.open(src_) || m.size() < to) return 0;
+        const char* p = m.data() + from;
+        const char* end = m.data() + to;
+        PacpResults::TextRecord r;
+        size_t n = 0;
+        uint64_t last_end = from;
+        while (p < end) {
+            const char* nl = (const char*)std::memchr(p, '\n', end - p);
+            if (!nl) break;                               // 最後一行還沒寫完
+            if (PacpResults::parse_text(p, nl, r)) {
+                uint64_t fp = r.h.fingerprint;
+                last_end = (uint64_t)(nl + 1 - m.data());
+                if (seen_.insert(fp).second) n++;
+                Entry e{ fp, last_end };
+                std::fwrite(&e, sizeof(e), 1, out_);
+            }
+            p = nl + 1;
+        }
+        // 尾端只有標頭 / 註解時也記下涵蓋範圍 (fingerprint 0)，下次不必再掃
+        uint64_t scanned = (uint64_t)(p - m.data());
+        if (scanned > last_end) {
+            Entry e{ 0, scanned };
+            std::fwrite(&e, sizeof(e), 1, out_);
+        }
+        return n;
+    }
+};
+
+#endif
@@ -0,0 +1,193 @@
+// ==========================================
+// Filename: pacp_census.h
+// Optimization: Orbit Counting (Census) without storing solutions
+// ==========================================
+//
+// 等價群 H = 循環位移 x 取負 (|H| = 2L)，與 canonical_key / get_canonical_repr 相同；
+// 配對再加上 A <-> B 交換。只列舉每個軌道的代表元 (約 2^L / 2L 個)，
+// 配對 {a, b} (a <= b) 恰好對應一個等價類，因此:
+//   等價類數   = 合格的代表元配對數
+//   有序配對數 = sum |H·a| * |H·b| * (a != b ? 2 : 1)，|H·a| = 2L / |Stab(a)|  (軌道-穩定子)
+// 記憶體只有代表元表 (與 L 有關，與解的數量無關)，樣本邊找邊寫入檔案。
+
+#ifndef PACP_CENSUS_H
+#define PACP_CENSUS_H
+
+#include "pacp_core.h"
+#include "pacp_bitslice.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+namespace Census {
+
+    constexpr int MAX_L = 30;   // 代表元表 ~ 2^L / 2L 筆
+
+    enum Goal { GOAL1 = 0, GOAL2 = 1, GOAL3 = 2, NUM_GOALS = 3 };
+    static const char* GOAL_NAME[NUM_GOALS] = { "Goal1", "Goal2", "Goal3" };
+    static const int GOAL_PSL[NUM_GOALS] = { 2, 4, 4 };
+
+    struct Tally {
+        unsigned long long classes = 0;   // 不等價配對數
+        unsigned long long labeled = 0;   // 有序 (A, B) 配對總數
+    };
+
+    // 代表元表，依 |sum| 排序，acf 只存 u = 1..L/2 (週期 ACF 對稱)
+    struct RepTable {
+        int L = 0, H = 0;
+        std::vector<uint32_t> bits;
+        std::vector<int> abs_sum;
+        std::vector<int> orbit;
+        std::vector<int8_t> acf;              // bits.size() * H
+        std::vector<size_t> bucket_begin;     // 依 |sum| 分組: [bucket_begin[k], bucket_begin[k+1])
+        std::vector<int> bucket_sum;
+
+        const int8_t* acf_of(size_t i) const { return acf.data() + i * H; }
+    };
+
+    inline void build_reps(int L, RepTable& t) {
+        t.L = L;
+        t.H = L / 2;
+
+        struct Entry { uint32_t bits; int abs_sum; int orbit; };
+        std::vector<Entry> reps;
+        uint64_t limit = 1ULL << L;
+        for (uint64_t j = 0; j < limit; ++j) {
+            int stab = 0;
+            if (BitSlice::canonical_key_stab(j, L, stab) != BitSlice::msb_first(j, L)) continue;
+            int sum = L - 2 * __builtin_popcountll(j);
+            reps.push_back({ (uint32_t)j, std::abs(sum), 2 * L / stab });
+        }
+        std::stable_sort(reps.begin(), reps.end(),
+                         [](const Entry& x, const Entry& y) { return x.abs_sum < y.abs_sum; });
+
+        size_t n = reps.size();
+        t.bits.resize(n);
+        t.abs_sum.resize(n);
+        t.orbit.resize(n);
+        t.acf.resize(n * t.H);
+        t.bucket_begin.clear();
+        t.bucket_sum.clear();
+
+        Seq s(L);
+        std::vector<int> acf(L);
+        for (size_t i = 0; i < n; ++i) {
+            t.bits[i] = reps[i].bits;
+            t.abs_sum[i] = reps[i].abs_sum;
+            t.orbit[i] = reps[i].orbit;
+            int_to_seq((int)reps[i].bits, L, s);
+            compute_periodic_acf(s, acf);
+            for (int u = 1; u <= t.H; ++u) t.acf[i * t.H + (u - 1)] = (int8_t)acf[u];
+
+            if (i == 0 || reps[i].abs_sum != reps[i - 1].abs_sum) {
+                t.bucket_begin.push_back(i);
+                t.bucket_sum.push_back(reps[i].abs_sum);
+            }
+        }
+        t.bucket_begin.push_back(n);
+    }
+
+    // 能量恆等式: sa^2 + sb^2 - 2L = sum_{u=1}^{L-1} S(u)
+    //   Goal 1 (奇數 L): 每個 S = +-2        -> |e| <= 2(L-1)
+    //   Goal 2 (偶數 L): 只有 S(L/2) = +-4   -> e = +-4
+    //   Goal 3 (偶數 L): S(u) = S(L-u) = +-4 -> e = +-8
+    inline bool bucket_admissible(int sa, int sb, int L) {
+        long long e = (long long)sa * sa + (long long)sb * sb - 2LL * L;
+        if (L % 2 == 1) return std::llabs(e) <= 2LL * (L - 1);
+        return std::llabs(e) == 4 || std::llabs(e) == 8;
+    }
+
+    // 回傳 Goal 編號，不符合任何目標則回傳 -1
+    inline int classify(const int8_t* a, const int8_t* b, int L) {
+        int H = L / 2;
+        if (L % 2 == 1) {
+            for (int u = 0; u < H; ++u) {
+                int v = a[u] + b[u];
+                if (v != 2 && v != -2) return -1;
+            }
+            return GOAL1;
+        }
+
+        int peaks = 0;
+        for (int u = 0; u < H - 1; ++u) {
+            int v = a[u] + b[u];
+            if (v == 0) continue;
+            if ((v != 4 && v != -4) || ++peaks > 1) return -1;
+        }
+        int mid = a[H - 1] + b[H - 1];
+        if (peaks == 0 && (mid == 4 || mid == -4)) return GOAL2;
+        if (peaks == 1 && mid == 0) return GOAL3;
+        return -1;
+    }
+
+    inline std::string bits_to_string(uint32_t bits, int L) {
+        std::string s(L, '+');
+        for (int i = 0; i < L; ++i) if ((bits >> i) & 1U) s[i] = '-';
+        return s;
+    }
+
+    // 主程序: max_samples > 0 時，每個 Goal 的前 max_samples 個代表配對寫入 sample_file
+    inline void run(int L, const std::string& out_file, long long max_samples) {
+        std::cout << "--------------------------------------------------\n";
+        std::cout << " CENSUS | L=" << L << " | Group: Shift x Negation x Swap\n";
+        std::cout << "--------------------------------------------------\n";
+
+        RepTable t;
+        build_reps(L, t);
+        size_t n = t.bits.size();
+        std::cout << "[Census] Orbit representatives: " << n << " (Buckets: " << t.bucket_sum.size() << ")\n";
+
+        std::ofstream samples;
+        std::string sample_file = out_file + ".samples";
+        if (max_samples > 0) {
+            samples.open(sample_file);
+            if (!samples.is_open()) std::cerr << "[Warning] Cannot open " << sample_file << std::endl;
+        }
+
+        Tally tally[NUM_GOALS];
+        size_t nb = t.bucket_sum.size();
+        for (size_t p = 0; p < nb; ++p) {
+            for (size_t q = p; q < nb; ++q) {
+                if (!bucket_admissible(t.bucket_sum[p], t.bucket_sum[q], L)) continue;
+
+                for (size_t i = t.bucket_begin[p]; i < t.bucket_begin[p + 1]; ++i) {
+                    const int8_t* acf_a = t.acf_of(i);
+                    size_t j0 = (p == q) ? i : t.bucket_begin[q];
+                    for (size_t j = j0; j < t.bucket_begin[q + 1]; ++j) {
+                        int g = classify(acf_a, t.acf_of(j), L);
+                        if (g < 0) continue;
+
+                        tally[g].classes++;
+                        tally[g].labeled += (unsigned long long)t.orbit[i] * t.orbit[j] * (i == j ? 1 : 2);
+
+                        if (samples.is_open() && (long long)tally[g].classes <= max_samples) {
+                            samples << GOAL_NAME[g] << "," << L << "," << GOAL_PSL[g] << ","
+                                    << bits_to_string(t.bits[i], L) << "," << bits_to_string(t.bits[j], L) << "\n";
+                        }
+                    }
+                }
+            }
+            std::cout << "\r[Census] Bucket " << (p + 1) << "/" << nb << "   " << std::flush;
+        }
+
+        std::ofstream outfile(out_file);
+        outfile << "L=" << L << ",Mode=Census,Reps=" << n << "\n";
+        std::cout << "\n--------------------------------------------------\n";
+        for (int g = 0; g < NUM_GOALS; ++g) {
+            bool applicable = (L % 2 == 1) ? (g == GOAL1) : (g != GOAL1);
+            if (!applicable) continue;
+            outfile << GOAL_NAME[g] << ",Classes=" << tally[g].classes << ",Labeled=" << tally[g].labeled << "\n";
+            std::cout << " " << GOAL_NAME[g] << " | Classes: " << std::setw(10) << tally[g].classes
+                      << " | Labeled (A,B): " << tally[g].labeled << "\n";
+        }
+        std::cout << "--------------------------------------------------\n";
+        if (samples.is_open()) std::cout << " Samples -> " << sample_file << "\n";
+    }
+}
+
+#endif
@@ -0,0 +1,159 @@
+// ==========================================
+// Filename: pacp_checkpoint.h
+// Optimization: Crash-Safe Binary Checkpoints (temp file + fsync + atomic rename)
+// ==========================================
+//
+// 長時間跑的 worker (optimizer_pqcp / optimizer2) 以前所有搜尋狀態都只在記憶體裡，
+// 一關機就全部重來 (見 plz.txt)。這裡提供一個很小的二進位快照格式:
+//   Header  : magic、版本、engine 種類、L、payload 長度、payload 的 FNV-1a 檢查碼
+//   Payload : 各 engine 自己依序 put / get 的欄位 (序列、sum_rho、tabu、RNG、計數器...)
+// 寫入時先寫 <path>.tmp、fsync，再 rename 蓋掉舊檔 (POSIX rename / Win32 MoveFileEx 都是原子的)，
+// 所以任何時間點斷電，磁碟上都只會是「完整的舊快照」或「完整的新快照」。
+// 讀取時 magic / 版本 / 種類 / L / 長度 / 檢查碼任一不符就當作沒有快照。
+
+#ifndef PACP_CHECKPOINT_H
+#define PACP_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+class Checkpoint {
+public:
+    static constexpr char MAGIC[8] = { 'P', 'A', 'C', 'P', 'C', 'K', 'P', '1' };
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t kind;       // engine 種類 (沿用 LiveStats::Kind)
+        uint32_t L;
+        uint32_t reserved;
+        uint64_t payload_bytes;
+        uint64_t checksum;   // payload 的 FNV-1a
+    };
+    static_assert(sizeof(Header) == 40, "Header layout");
+
+    /* ---------- 寫入 ---------- */
+    void clear() {
+        buf_.clear();
+        pos_ = 0;
+    }
+
+    template <class T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() needs a trivially copyable type");
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf_.insert(buf_.end(), p, p + sizeof(T));
+    }
+
+    template <class T>
+    void put_vec(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put_vec() needs a trivially copyable type");
+        put<uint64_t>(v.size());
+        const char* p = reinterpret_cast<const char*>(v.data());
+        buf_.insert(buf_.end(), p, p + v.size() * sizeof(T));
+    }
+
+    // 原子地寫出目前的 payload；失敗時舊快照保持不變
+    bool save(const std::string& path, uint32_t kind, int L) const {
+        Header h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.kind = kind;
+        h.L = (uint32_t)L;
+        h.payload_bytes = buf_.size();
+        h.checksum = fnv(buf_.data(), buf_.size());
+
+        std::string tmp = path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  (buf_.empty() || std::fwrite(buf_.data(), 1, buf_.size(), f) == buf_.size()) &&
+                  std::fflush(f) == 0;
+#ifdef _WIN32
+        ok = ok && ::_commit(::_fileno(f)) == 0;
+#else
+        ok = ok && ::fsync(::fileno(f)) == 0;
+#endif
+        ok = (std::fclose(f) == 0) && ok;
+        if (!ok) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        return MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+    }
+
+    /* ---------- 讀取 ---------- */
+    // 讀入並驗證快照；之後依寫入順序 get / get_vec
+    bool load(const std::string& path, uint32_t kind, int L) {
+        clear();
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        Header h;
+        bool ok = std::fread(&h, sizeof(h), 1, f) == 1 && std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                  h.version == VERSION && h.kind == kind && h.L == (uint32_t)L && h.payload_bytes < (1ULL << 32);
+        if (ok) {
+            buf_.resize(h.payload_bytes);
+            ok = buf_.empty() || std::fread(buf_.data(), 1, buf_.size(), f) == buf_.size();
+        }
+        std::fclose(f);
+        if (!ok || fnv(buf_.data(), buf_.size()) != h.checksum) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    template <class T>
+    bool get(T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "get() needs a trivially copyable type");
+        if (buf_.size() - pos_ < sizeof(T)) return false;
+        std::memcpy(&v, buf_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    // expect: 預期的元素個數 (長度不符代表快照與目前設定不一致)
+    template <class T>
+    bool get_vec(std::vector<T>& v, size_t expect) {
+        uint64_t n = 0;
+        if (!get(n) || n != expect || (buf_.size() - pos_) / sizeof(T) < n) return false;
+        v.resize(n);
+        if (n) std::memcpy(v.data(), buf_.data() + pos_, n * sizeof(T));
+        pos_ += n * sizeof(T);
+        return true;
+    }
+
+private:
+    std::vector<char> buf_;
+    size_t pos_ = 0;
+
+    static uint64_t fnv(const char* p, size_t n) {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= (unsigned char)p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "pacp_core.h"
+#include "pacp_results.h"
 #include <iomanip>
 #include <set>
+#include <cstring>
 
 void compute_acf(const Seq& s, std::vector<int>& acf_out) {
     int L = s.size();
@@ -31,6 +33,17 @@ void rotate_seq_left(Seq& s, int k) {
     std::rotate(s.begin(), s.begin() + k, s.end());
 }
 
+void flip_update_periodic_acf(Seq& s, std::vector<int>& acf, int p) {
+    int L = s.size();
+    int val_p = s[p];
+    for (int u = 1; u < L; ++u) {
+        int p_plus = p + u; if (p_plus >= L) p_plus -= L;
+        int p_minus = p - u; if (p_minus < 0) p_minus += L;
+        acf[u] += -2 * val_p * (s[p_plus] + s[p_minus]);
+    }
+    s[p] = -val_p;
+}
+
 int calc_psl(const std::vector<int>& acf_a, const std::vector<int>& acf_b, int L) {
     int max_sidelobe = 0;
     for (int u = 1; u < L; ++u) {
@@ -50,29 +63,23 @@ long long calc_mse_cost(const std::vector<int>& acf_a, const std::vector<int>& a
 }
 
 std::string get_canonical_repr(const Seq& s) {
+    // [New] 不再逐一位移 + 建字串：把序列與其取負各接成兩倍長，
+    // 第 i 個長度 L 的視窗就是左移 i 位的結果，直接 memcmp 取最小 (結果與舊版相同)
     int L = s.size();
-    auto to_str = [](const Seq& v) {
-        std::string out; 
-        for(int x : v) out += (x==1 ? "+" : "-");
-        return out;
-    };
-
-    std::string min_str = to_str(s);
-    Seq curr = s;
-
-    // Check all cyclic shifts and negations
-    for(int i=0; i<L; ++i) {
-        std::string temp = to_str(curr);
-        if(temp < min_str) min_str = temp;
-        
-        Seq neg = curr;
-        for(int& x : neg) x *= -1;
-        temp = to_str(neg);
-        if(temp < min_str) min_str = temp;
+    std::string pos(2 * L, '+'), neg(2 * L, '+');
+    for (int i = 0; i < L; ++i) {
+        char c = (s[i] == 1) ? '+' : '-';
+        char n = (s[i] == 1) ? '-' : '+';
+        pos[i] = pos[i + L] = c;
+        neg[i] = neg[i + L] = n;
+    }
 
-        rotate_seq_left(curr, 1);
+    const char* best = pos.data();
+    for (int i = 0; i < L; ++i) {
+        if (std::memcmp(pos.data() + i, best, L) < 0) best = pos.data() + i;
+        if (std::memcmp(neg.data() + i, best, L) < 0) best = neg.data() + i;
     }
-    return min_str;
+    return std::string(best, L);
 }
 
 void int_to_seq(int val, int L, Seq& s) {
@@ -100,36 +107,54 @@ void save_result_list(const std::string& filename, const std::vector<std::pair<S
 }
 
 bool load_result(const std::string& filename, Seq& a, Seq& b) {
-    std::ifstream infile(filename);
-    if(!infile.is_open()) return false;
-    
-    std::string s;
-    std::vector<std::string> seqs;
-    
-    while(infile >> s) {
-        size_t comma_pos = s.find(',');
-        if (comma_pos != std::string::npos) {
-            std::string part1 = s.substr(0, comma_pos);
-            std::string part2 = s.substr(comma_pos + 1);
-            if(part1.find_first_of("+-10") != std::string::npos) seqs.push_back(part1);
-            if(part2.find_first_of("+-10") != std::string::npos) seqs.push_back(part2);
-        } else {
-            if(s.length() > 1 && (s.find('+') != std::string::npos || s.find('-') != std::string::npos)) 
-                seqs.push_back(s);
+    // [New] mmap + PacpResults::parse_text (不再用 >> 把整個檔切成 vector<string>):
+    //       任何結果方言都取最後一筆；都不是 (例如 A、B 各佔一行) 時取最後兩個只含 +-10 的 token
+    MappedFile m;
+    if (!m.open(filename) || m.size() == 0) return false;
+    const char* data = m.data();
+    const char* end = data + m.size();
+
+    PacpParse::LineScanner lines(data, end);
+    PacpResults::TextRecord t, last;
+    bool found = false;
+    const char* lb;
+    const char* le;
+    while (lines.next(lb, le)) {
+        if (PacpResults::parse_text(lb, le, t, false)) {
+            last = t;
+            found = true;
         }
     }
-    
-    if(seqs.size() < 2) return false;
-    
-    auto parse = [](std::string in, Seq& out) {
-        out.clear();
-        for(char c : in) {
-            if(c == '+' || c == '1') out.push_back(1);
-            else if(c == '-' || c == '0') out.push_back(-1);
+    if (found) {
+        a.resize(last.h.L);
+        b.resize(last.h.L);
+        PacpParse::decode_pm(last.a, last.h.L, a.data());
+        PacpParse::decode_pm(last.b, last.h.L, b.data());
+        return true;
+    }
+
+    auto is_sep = [](char c) { return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    auto is_bit = [](char c) { return c == '+' || c == '-' || c == '1' || c == '0'; };
+    const char* tok[2] = { nullptr, nullptr };
+    size_t len[2] = { 0, 0 };
+    for (const char* p = data; p < end;) {
+        while (p < end && is_sep(*p)) ++p;
+        const char* q = p;
+        bool ok = true;
+        while (q < end && !is_sep(*q)) ok = is_bit(*q++) && ok;
+        if (ok && q - p > 1) {
+            tok[0] = tok[1]; len[0] = len[1];
+            tok[1] = p; len[1] = (size_t)(q - p);
         }
+        p = q;
+    }
+    if (!tok[0]) return false;
+
+    auto parse = [](const char* in, size_t n, Seq& out) {
+        out.resize(n);
+        for (size_t i = 0; i < n; ++i) out[i] = (in[i] == '+' || in[i] == '1') ? 1 : -1;
     };
-    
-    parse(seqs[seqs.size()-2], a);
-    parse(seqs[seqs.size()-1], b);
+    parse(tok[0], len[0], a);
+    parse(tok[1], len[1], b);
     return true;
-}
\ No newline at end of file
+}
@@ -34,4 +34,7 @@ bool load_result(const std::string& filename, Seq& a, Seq& b);
 void int_to_seq(int val, int L, Seq& s);
 void rotate_seq_left(Seq& s, int k);
 
+// [New] Flip s[p] and update its periodic ACF in O(L)
+void flip_update_periodic_acf(Seq& s, std::vector<int>& acf, int p);
+
 #endif
\ No newline at end of file
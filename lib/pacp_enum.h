@@ -0,0 +1,50 @@
+// ==========================================
+// Filename: pacp_enum.h
+// Optimization: Sum-Constrained (Hamming Weight) Enumeration
+// ==========================================
+//
+// 週期能量恆等式:  sum(A)^2 + sum(B)^2 = 2L + sum_{u=1}^{L-1} (rhoA(u) + rhoB(u))
+// 若所有旁瓣 |rhoA(u)+rhoB(u)| <= P，則 |sum(A)^2 + sum(B)^2 - 2L| <= (L-1) * P。
+// 以 bit=1 表示 -1 (與 int_to_seq 相同)，權重 w 個 -1 的序列和為 L - 2w。
+
+#ifndef PACP_ENUM_H
+#define PACP_ENUM_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+namespace WeightEnum {
+
+    inline int sum_of_weight(int L, int w) { return L - 2 * w; }
+
+    // 是否可能存在 PSL <= psl_bound 的配對
+    inline bool energy_admissible(int sum_a, int sum_b, int L, long long psl_bound) {
+        long long e = (long long)sum_a * sum_a + (long long)sum_b * sum_b - 2LL * L;
+        return std::llabs(e) <= (long long)(L - 1) * psl_bound;
+    }
+
+    // Gosper's hack: 下一個相同 popcount 的整數 (組合數系統 / colex 順序)
+    // 相鄰兩個遮罩平均只差幾個 bit，可逐 bit 增量更新 ACF
+    inline uint64_t next_same_weight(uint64_t x) {
+        if (x == 0) return ~0ULL; // 權重 0 只有一個
+        uint64_t r = x + (x & (~x + 1));
+        if (r == 0) return ~0ULL; // 溢位: 已是最後一個
+        return (((r ^ x) >> 2) >> __builtin_ctzll(x)) | r;
+    }
+
+    inline uint64_t first_of_weight(int w) { return (w >= 64) ? ~0ULL : ((1ULL << w) - 1); }
+
+    // 權重 0..n 依 |sum^2 - L| 由小到大排序: 能量平均分給 A、B 的類別最可能達到低 PSL，
+    // 先掃它們可讓 PSL 上限 (以及允許的類別) 儘早收斂
+    inline std::vector<int> weights_by_energy(int n, int L) {
+        std::vector<int> order(n + 1);
+        for (int w = 0; w <= n; ++w) order[w] = w;
+        auto score = [L](int w) { int s = sum_of_weight(L, w); return std::abs(s * s - L); };
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return score(a) < score(b); });
+        return order;
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define PACP_IO_H
 
 #include "pacp_core.h"
+#include "pacp_canon_index.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -11,7 +12,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <set>
-#include <sstream> // 補上
+#include <chrono>
 
 namespace fs = std::filesystem;
 
@@ -79,53 +80,59 @@ inline void save_session_report(const std::string& base_filename, int L, const s
     std::cout << "[Report] Session stats saved to " << report_file << "\n";
 }
 
+// [New] 改用 PacpResults::parse_text (memchr 切欄位、不複製字串)；
+//       L,PSL,A,B 與 L,PSL,ZCZ,A,B 兩種 Goal 1 格式都接受
 inline bool parse_csv_line(const std::string& line, int& L, int& psl, Seq& A, Seq& B) {
-    std::stringstream ss(line);
-    std::string segment;
-    std::vector<std::string> parts;
-    while(std::getline(ss, segment, ',')) parts.push_back(segment);
-    if (parts.size() < 4) return false;
-    try {
-        L = std::stoi(parts[0]);
-        psl = std::stoi(parts[1]);
-        std::string sA = parts[2];
-        std::string sB = parts[3];
-        sA.erase(std::remove_if(sA.begin(), sA.end(), ::isspace), sA.end());
-        sB.erase(std::remove_if(sB.begin(), sB.end(), ::isspace), sB.end());
-        A.resize(L); B.resize(L);
-        for(int i=0; i<L; ++i) A[i] = (sA[i] == '+') ? 1 : -1;
-        for(int i=0; i<L; ++i) B[i] = (sB[i] == '+') ? 1 : -1;
-        return true;
-    } catch (...) { return false; }
+    PacpResults::TextRecord t;
+    if (!PacpResults::parse_text(line.data(), line.data() + line.size(), t, false)) return false;
+    if (t.h.tag != PacpResults::TAG_CSV && t.h.tag != PacpResults::TAG_CSV_ZCZ) return false;
+    L = t.h.L;
+    psl = t.h.psl;
+    A.resize(L); B.resize(L);
+    PacpParse::decode_pm(t.a, L, A.data());
+    PacpParse::decode_pm(t.b, L, B.data());
+    return true;
 }
 
+// [New] 只讀第一行 (mmap)；A,B 或 L,PSL,A,B 都可
 inline bool load_seed_csv(const std::string& filename, Seq& A, Seq& B) {
-    if (!fs::exists(filename)) return false;
-    std::ifstream infile(filename);
-    std::string line;
-    if (std::getline(infile, line)) {
-        int L, psl_dummy; 
-        if (line.find(',') != std::string::npos) {
-             return parse_csv_line(line, L, psl_dummy, A, B) || 
-                    parse_csv_line("0,0,"+line, L, psl_dummy, A, B); 
-        }
-    }
-    return false;
+    MappedFile m;
+    if (!m.open(filename) || m.size() == 0) return false;
+    PacpParse::LineScanner lines(m.data(), m.data() + m.size());
+    const char* b;
+    const char* e;
+    PacpResults::TextRecord t;
+    if (!lines.next(b, e) || !PacpResults::parse_text(b, e, t, false)) return false;
+    if (t.h.tag != PacpResults::TAG_PAIR && t.h.tag != PacpResults::TAG_CSV) return false;
+    A.resize(t.h.L); B.resize(t.h.L);
+    PacpParse::decode_pm(t.a, t.h.L, A.data());
+    PacpParse::decode_pm(t.b, t.h.L, B.data());
+    return true;
+}
+
+// [New] 指紋版: 透過 sidecar (<filename>.cidx) 載入，只有 index 不存在 / 過期時才解析結果檔，
+// 之後每 append 一行就呼叫 index.add(PacpResults::canonical_fingerprint(A, B))
+inline bool load_existing_results(const std::string& filename, CanonIndex& index) {
+    ensure_file_dir(filename);
+    return index.open(filename);
 }
 
 inline void load_existing_results(const std::string& filename, std::set<std::pair<std::string, std::string>>& seen) {
-    if (!fs::exists(filename)) return;
-    std::ifstream infile(filename);
-    std::string line;
-    while (std::getline(infile, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        int L, psl; Seq A, B;
-        if (parse_csv_line(line, L, psl, A, B)) {
-            std::string ca = get_canonical_repr(A);
-            std::string cb = get_canonical_repr(B);
-            if (ca > cb) std::swap(ca, cb);
-            seen.insert({ca, cb});
-        }
+    MappedFile m;
+    if (!m.open(filename) || m.size() == 0) return;
+    PacpParse::LineScanner lines(m.data(), m.data() + m.size());
+    const char* b;
+    const char* e;
+    PacpResults::TextRecord t;
+    std::string buf_a, buf_b;
+    while (lines.next(b, e)) {
+        if (!PacpResults::parse_text(b, e, t, false)) continue;
+        if (t.h.tag != PacpResults::TAG_CSV && t.h.tag != PacpResults::TAG_CSV_ZCZ) continue;
+        int L = t.h.L;
+        std::string ca(PacpParse::canonical_min(t.a, L, buf_a), L);
+        std::string cb(PacpParse::canonical_min(t.b, L, buf_b), L);
+        if (ca > cb) std::swap(ca, cb);
+        seen.insert({ca, cb});
     }
 }
 
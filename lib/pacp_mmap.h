@@ -0,0 +1,108 @@
+// ==========================================
+// Filename: pacp_mmap.h
+// Optimization: Read-only Memory-Mapped Files (POSIX / Win32)
+// ==========================================
+//
+// 大檔 (候選池、結果檔) 直接映射進位址空間，不經過 ifstream 複製。
+// Windows (MSYS2 UCRT64) 用 CreateFileMapping / MapViewOfFile，其他平台用 mmap。
+
+#ifndef PACP_MMAP_H
+#define PACP_MMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 空檔案也算成功 (size() == 0, data() == nullptr)
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file_, &sz)) { close(); return false; }
+        size_ = (size_t)sz.QuadPart;
+        if (size_ == 0) return true;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) { close(); return false; }
+        data_ = (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (!data_) { close(); return false; }
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) { close(); return false; }
+        size_ = (size_t)st.st_size;
+        if (size_ == 0) return true;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        data_ = (const char*)p;
+        madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap((void*)data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_open() const {
+#ifdef _WIN32
+        return file_ != INVALID_HANDLE_VALUE;
+#else
+        return fd_ >= 0;
+#endif
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    template <typename T>
+    const T* as() const { return reinterpret_cast<const T*>(data_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+#endif
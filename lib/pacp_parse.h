@@ -0,0 +1,168 @@
+// ==========================================
+// Filename: pacp_parse.h
+// Optimization: Zero-Allocation Line / Field Scanner + SIMD '+'/'-' Decoding
+// ==========================================
+//
+// 以前的讀檔路徑每行都要 stringstream + vector<string> + erase 複本 (parse_csv_line)，
+// load_result 甚至用 >> 把整個檔切成 vector<string>。這裡是共用的最底層:
+//   LineScanner   : 在 mmap 的區段上用 memchr 找換行，回傳 [b, e) 指標 (去掉 \r 與行尾空白)
+//   split_fields  : memchr 找 ','，欄位前後空白一併去掉，不複製
+//   is_pm         : 整段是否只有 '+' / '-' (AVX2 / SSE2 一次比 32 / 16 bytes)
+//   pack_pm       : '+'/'-' 直接轉成 packed bits (bit i = 1 表示 '-'，同 PacpResults::pack)，
+//                   cmpeq + movemask 一次處理 32 / 16 個字元
+//   decode_pm     : 轉成 Seq (+1 / -1)
+//   canonical_min : 從字元直接找 get_canonical_repr 的結果 (不經過 Seq)
+// 各種結果方言的辨識在 PacpResults::parse_text (pacp_results.h)，建立在這些函式之上。
+
+#ifndef PACP_PARSE_H
+#define PACP_PARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace PacpParse {
+
+    inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    /* =========================
+       Lines / Fields
+       ========================= */
+    class LineScanner {
+    public:
+        LineScanner(const char* b, const char* e) : p_(b), end_(b ? e : b) {}
+
+        // 下一個非空行；檔尾沒有換行的最後一行也會回傳
+        bool next(const char*& b, const char*& e) {
+            while (p_ < end_) {
+                const char* nl = (const char*)std::memchr(p_, '\n', end_ - p_);
+                const char* le = nl ? nl : end_;
+                b = p_;
+                e = le;
+                p_ = nl ? nl + 1 : end_;
+                while (e > b && is_blank(e[-1])) --e;
+                if (e > b) return true;
+            }
+            return false;
+        }
+
+        const char* pos() const { return p_; }
+
+    private:
+        const char* p_;
+        const char* end_;
+    };
+
+    // 以 sep 切開 [b, e)，最多 max 個欄位 (超過的部分併在最後一欄)；回傳欄位數
+    inline int split_fields(const char* b, const char* e, char sep, const char** f, const char** fe, int max) {
+        int n = 0;
+        const char* p = b;
+        while (n < max) {
+            const char* c = (n == max - 1) ? nullptr : (const char*)std::memchr(p, sep, e - p);
+            const char* q = c ? c : e;
+            const char* fb = p;
+            while (fb < q && is_blank(*fb)) ++fb;
+            const char* fq = q;
+            while (fq > fb && is_blank(fq[-1])) --fq;
+            f[n] = fb;
+            fe[n] = fq;
+            n++;
+            if (!c) break;
+            p = c + 1;
+        }
+        return n;
+    }
+
+    /* =========================
+       '+' / '-' Runs
+       ========================= */
+    // 把 s[0..L) 轉成 packed bits 寫進 out (words_for(L) 個 word，呼叫前不需清零)；
+    // 出現 '+' / '-' 以外的字元時回傳 false
+    inline bool pack_pm(const char* s, int L, uint64_t* out) {
+        std::memset(out, 0, (size_t)((L + 63) / 64) * sizeof(uint64_t));
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i minus = _mm256_set1_epi8('-'), plus = _mm256_set1_epi8('+');
+        for (; i + 32 <= L; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, minus));
+            uint32_t p = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, plus));
+            if ((m | p) != 0xFFFFFFFFu) return false;
+            out[i >> 6] |= (uint64_t)m << (i & 63);
+        }
+#elif defined(__SSE2__)
+        const __m128i minus = _mm_set1_epi8('-'), plus = _mm_set1_epi8('+');
+        for (; i + 16 <= L; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, minus));
+            uint32_t p = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, plus));
+            if ((m | p) != 0xFFFFu) return false;
+            out[i >> 6] |= (uint64_t)m << (i & 63);
+        }
+#endif
+        for (; i < L; ++i) {
+            if (s[i] == '-') out[i >> 6] |= 1ULL << (i & 63);
+            else if (s[i] != '+') return false;
+        }
+        return true;
+    }
+
+    inline bool is_pm(const char* s, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i minus = _mm256_set1_epi8('-'), plus = _mm256_set1_epi8('+');
+        for (; i + 32 <= n; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            __m256i ok = _mm256_or_si256(_mm256_cmpeq_epi8(v, minus), _mm256_cmpeq_epi8(v, plus));
+            if ((uint32_t)_mm256_movemask_epi8(ok) != 0xFFFFFFFFu) return false;
+        }
+#elif defined(__SSE2__)
+        const __m128i minus = _mm_set1_epi8('-'), plus = _mm_set1_epi8('+');
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i ok = _mm_or_si128(_mm_cmpeq_epi8(v, minus), _mm_cmpeq_epi8(v, plus));
+            if ((uint32_t)_mm_movemask_epi8(ok) != 0xFFFFu) return false;
+        }
+#endif
+        for (; i < n; ++i) if (s[i] != '+' && s[i] != '-') return false;
+        return true;
+    }
+
+    // out[i] = +1 / -1 (呼叫端已確認只有 '+' / '-'；這個迴圈編譯器會自動向量化)
+    template <class T>
+    inline void decode_pm(const char* s, int L, T* out) {
+        for (int i = 0; i < L; ++i) out[i] = (s[i] == '+') ? 1 : -1;
+    }
+
+    /* =========================
+       Canonical Form (from chars)
+       ========================= */
+    // 與 get_canonical_repr 相同 (循環位移 x 取負中字典序最小)，但直接吃字元；
+    // 回傳指向 buf 內長度 L 的視窗 (buf 由呼叫端重複使用，不會每次配置)
+    inline const char* canonical_min(const char* s, int L, std::string& buf) {
+        buf.resize(4 * (size_t)L);
+        char* pos = &buf[0];
+        char* neg = pos + 2 * L;
+        for (int i = 0; i < L; ++i) {
+            char c = (s[i] == '+') ? '+' : '-';
+            char n = (c == '+') ? '-' : '+';
+            pos[i] = pos[i + L] = c;
+            neg[i] = neg[i + L] = n;
+        }
+        const char* best = pos;
+        for (int i = 0; i < L; ++i) {
+            if (std::memcmp(pos + i, best, L) < 0) best = pos + i;
+            if (std::memcmp(neg + i, best, L) < 0) best = neg + i;
+        }
+        return best;
+    }
+}
+
+#endif
@@ -0,0 +1,448 @@
+// ==========================================
+// Filename: pacp_results.h
+// Optimization: Versioned Binary Result Records (mmap Zero-Copy Reader)
+// ==========================================
+//
+// 文字結果檔至少有這幾種方言，每次讀取都要用 stringstream 逐字元解析:
+//   Goal 1      : L,PSL,A,B                          (optimizer / append_result_to_file)
+//   Goal 1 SZCP : L,PSL,ZCZ,A,B                      (append_szcp_to_file)
+//   Goal 2      : OPT|SZCP|NEAR,L=..,Mid=..,A,B      (optimizer2)
+//   Goal 3      : PQCP|NEAR,L=..,Max=..,Peaks=..,A,B (optimizer_pqcp)
+//   配對        : A,B                                 (seed / aps unique_result)
+// 二進位格式: FileHeader + 連續的 record，每筆 = 固定 32 bytes 的 RecordHeader
+// + A、B 各 words 個 uint64_t (bit i = 1 表示 s[i] = -1，與 int_to_seq 相同)。
+// tag 記下原本的方言，轉回文字時逐字元還原。讀取端 mmap 後直接走訪，不做任何配置。
+// 標頭 (L=..,PSL=..,Count=..)、# 註解、以及無法由 tag 原樣還原的行 (例如 L 欄與序列長度不符)
+// 存成 TAG_TEXT 記錄 (version 2)，原文放在 A/B 區；for_each 不會交出這些記錄。
+// 空行與行尾空白不保留。
+
+#ifndef PACP_RESULTS_H
+#define PACP_RESULTS_H
+
+#include "pacp_core.h"
+#include "pacp_mmap.h"
+#include "pacp_parse.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace PacpResults {
+
+    constexpr char MAGIC[8] = { 'P', 'A', 'C', 'P', 'R', 'E', 'S', '1' };
+    constexpr uint32_t VERSION = 2;   // 2: 新增 TAG_TEXT；version 1 的檔案仍可讀
+
+    enum Tag : uint8_t {
+        TAG_CSV = 0,        // L,PSL,A,B
+        TAG_CSV_ZCZ = 1,    // L,PSL,ZCZ,A,B
+        TAG_OPT = 2,        // OPT,L=..,Mid=..
+        TAG_SZCP = 3,       // SZCP,L=..,Mid=..
+        TAG_NEAR_MID = 4,   // NEAR,L=..,Mid=..
+        TAG_PQCP = 5,       // PQCP,L=..,Max=..,Peaks=..
+        TAG_NEAR_PEAKS = 6, // NEAR,L=..,Max=..,Peaks=..
+        TAG_PAIR = 7,       // A,B
+        TAG_TEXT = 8        // 原文行 (標頭 / 註解)；extra = 位元組數，不是結果
+    };
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_header_bytes;
+    };
+
+    struct RecordHeader {
+        uint16_t L;
+        uint8_t goal;          // 1, 2, 3 (0: 未知)
+        uint8_t tag;           // Tag
+        int16_t psl;           // PSL / Max (-1: 無)
+        int16_t peaks;         // Peaks (-1: 無)
+        int32_t extra;         // Mid (Goal 2) / ZCZ (CSV_ZCZ)
+        uint32_t words;        // 每條序列的 uint64_t 數
+        uint64_t fingerprint;  // canonical_fingerprint(A, B)
+        int64_t timestamp;     // 寫入時間 (文字轉入為 0)
+    };
+
+    static_assert(sizeof(FileHeader) == 16, "FileHeader must stay mmap-compatible");
+    static_assert(sizeof(RecordHeader) == 32, "RecordHeader must stay mmap-compatible");
+
+    inline uint32_t words_for(int L) { return (uint32_t)((L + 63) / 64); }
+
+    inline void pack(const Seq& s, uint64_t* out) {
+        int L = (int)s.size();
+        std::memset(out, 0, words_for(L) * sizeof(uint64_t));
+        for (int i = 0; i < L; ++i) if (s[i] < 0) out[i >> 6] |= (1ULL << (i & 63));
+    }
+
+    inline void unpack(const uint64_t* w, int L, Seq& s) {
+        s.resize(L);
+        for (int i = 0; i < L; ++i) s[i] = ((w[i >> 6] >> (i & 63)) & 1ULL) ? -1 : 1;
+    }
+
+    inline void append_chars(const uint64_t* w, int L, std::string& out) {
+        for (int i = 0; i < L; ++i) out += ((w[i >> 6] >> (i & 63)) & 1ULL) ? '-' : '+';
+    }
+
+    // 等價類指紋: {A, B} 各取 get_canonical_repr (循環位移 x 取負)，排序後做 FNV-1a，
+    // 與 load_existing_results 的去重規則相同
+    inline uint64_t canonical_fingerprint(const Seq& A, const Seq& B) {
+        std::string ca = get_canonical_repr(A);
+        std::string cb = get_canonical_repr(B);
+        if (ca > cb) std::swap(ca, cb);
+        uint64_t h = 1469598103934665603ULL;
+        auto mix = [&](const std::string& s) {
+            for (unsigned char c : s) {
+                h ^= c;
+                h *= 1099511628211ULL;
+            }
+        };
+        mix(ca);
+        mix(",");
+        mix(cb);
+        return h;
+    }
+
+    // 同上，但直接從 '+'/'-' 字元計算 (解析文字時不必先轉成 Seq)；結果與 canonical_fingerprint 相同
+    inline uint64_t canonical_fingerprint_chars(const char* a, const char* b, int L) {
+        static thread_local std::string buf_a, buf_b;
+        const char* ca = PacpParse::canonical_min(a, L, buf_a);
+        const char* cb = PacpParse::canonical_min(b, L, buf_b);
+        if (std::memcmp(ca, cb, L) > 0) std::swap(ca, cb);
+        uint64_t h = 1469598103934665603ULL;
+        auto mix = [&](const char* p, int n) {
+            for (int i = 0; i < n; ++i) {
+                h ^= (unsigned char)p[i];
+                h *= 1099511628211ULL;
+            }
+        };
+        mix(ca, L);
+        mix(",", 1);
+        mix(cb, L);
+        return h;
+    }
+
+    // 一筆結果 (解析 / 寫入時使用)
+    struct Record {
+        RecordHeader h{};
+        Seq A, B;
+    };
+
+    /* =========================
+       Text Dialects
+       ========================= */
+    namespace detail {
+        inline bool parse_int(const char*& p, const char* end, long& v) {
+            bool neg = (p < end && *p == '-');
+            const char* q = neg ? p + 1 : p;
+            if (q == end || *q < '0' || *q > '9') return false;
+            long x = 0;
+            while (q < end && *q >= '0' && *q <= '9') x = x * 10 + (*q++ - '0');
+            v = neg ? -x : x;
+            p = q;
+            return true;
+        }
+
+        inline bool is_seq(const char* b, const char* e) {
+            return b != e && PacpParse::is_pm(b, (size_t)(e - b));
+        }
+
+        inline bool field_is(const char* b, const char* e, const char* word) {
+            size_t n = std::strlen(word);
+            return (size_t)(e - b) == n && std::memcmp(b, word, n) == 0;
+        }
+
+        // "key=" 開頭的欄位取值
+        inline bool field_value(const char* b, const char* e, const char* key, long& v) {
+            size_t n = std::strlen(key);
+            if ((size_t)(e - b) <= n || std::strncmp(b, key, n) != 0) return false;
+            const char* p = b + n;
+            return parse_int(p, e, v) && p == e;
+        }
+    }
+
+    // 一行文字的零複製解析結果: A、B 指向原本的行 (mmap 區段)，長度為 h.L
+    struct TextRecord {
+        RecordHeader h{};
+        const char* a = nullptr;
+        const char* b = nullptr;
+    };
+
+    // 辨識一行 (不含換行) 的方言並取出欄位，不做任何配置。只認得單行的 PAIR / CSV / CSV_ZCZ /
+    // OPT|SZCP|NEAR Mid= / PQCP|NEAR Max=,Peaks= (見 Tag)；多行格式不支援。
+    // 標頭 (L=..,PSL=..,Count=..)、註解、空行回傳 false。fingerprint = false 時不算指紋 (省下 O(L^2))
+    inline bool parse_text(const char* b, const char* e, TextRecord& t, bool fingerprint = true) {
+        while (e > b && PacpParse::is_blank(e[-1])) --e;
+        if (b == e || *b == '#') return false;
+
+        const char* f[8];
+        const char* fe[8];
+        int n = PacpParse::split_fields(b, e, ',', f, fe, 8);
+        if (n < 2 || !detail::is_seq(f[n - 2], fe[n - 2]) || !detail::is_seq(f[n - 1], fe[n - 1])) return false;
+
+        RecordHeader& h = t.h;
+        h = RecordHeader{};
+        h.psl = -1;
+        h.peaks = -1;
+        long v = 0, v2 = 0, v3 = 0;
+        bool is_opt = detail::field_is(f[0], fe[0], "OPT"), is_szcp = detail::field_is(f[0], fe[0], "SZCP");
+        bool is_near = detail::field_is(f[0], fe[0], "NEAR"), is_pqcp = detail::field_is(f[0], fe[0], "PQCP");
+
+        if (n == 2) {
+            h.tag = TAG_PAIR;
+        } else if (n == 4 && detail::field_value(f[0], fe[0], "", v) && detail::field_value(f[1], fe[1], "", v2)) {
+            h.tag = TAG_CSV;
+            h.goal = 1;
+            h.psl = (int16_t)v2;
+        } else if (n == 5 && detail::field_value(f[0], fe[0], "", v) && detail::field_value(f[1], fe[1], "", v2) &&
+                   detail::field_value(f[2], fe[2], "", v3)) {
+            h.tag = TAG_CSV_ZCZ;
+            h.goal = 1;
+            h.psl = (int16_t)v2;
+            h.extra = (int32_t)v3;
+        } else if (n == 5 && (is_opt || is_szcp || is_near) &&
+                   detail::field_value(f[1], fe[1], "L=", v) && detail::field_value(f[2], fe[2], "Mid=", v2)) {
+            h.tag = is_opt ? TAG_OPT : is_szcp ? TAG_SZCP : TAG_NEAR_MID;
+            h.goal = 2;
+            h.extra = (int32_t)v2;
+        } else if (n == 6 && (is_pqcp || is_near) && detail::field_value(f[1], fe[1], "L=", v) &&
+                   detail::field_value(f[2], fe[2], "Max=", v2) && detail::field_value(f[3], fe[3], "Peaks=", v3)) {
+            h.tag = is_pqcp ? TAG_PQCP : TAG_NEAR_PEAKS;
+            h.goal = 3;
+            h.psl = (int16_t)v2;
+            h.peaks = (int16_t)v3;
+        } else {
+            return false;
+        }
+
+        int L = (int)(fe[n - 2] - f[n - 2]);
+        if ((int)(fe[n - 1] - f[n - 1]) != L || L > 0xFFFF) return false;
+        h.L = (uint16_t)L;
+        h.words = words_for(L);
+        t.a = f[n - 2];
+        t.b = f[n - 1];
+        if (fingerprint) h.fingerprint = canonical_fingerprint_chars(t.a, t.b, L);
+        return true;
+    }
+
+    // 解析一行並展開成 Seq (r.A / r.B 的容量會重複使用)
+    inline bool parse_line(const char* b, const char* e, Record& r) {
+        TextRecord t;
+        if (!parse_text(b, e, t)) return false;
+        r.h = t.h;
+        r.A.resize(t.h.L);
+        r.B.resize(t.h.L);
+        PacpParse::decode_pm(t.a, t.h.L, r.A.data());
+        PacpParse::decode_pm(t.b, t.h.L, r.B.data());
+        return true;
+    }
+
+    // 依 tag 還原成原本的文字行 (不含換行)
+    inline void format_line(const RecordHeader& h, const uint64_t* a, const uint64_t* b, std::string& out) {
+        static const char* TYPE[] = { "", "", "OPT", "SZCP", "NEAR", "PQCP", "NEAR", "" };
+        out.clear();
+        std::string L = std::to_string(h.L);
+        switch (h.tag) {
+            case TAG_CSV: out += L + "," + std::to_string(h.psl) + ","; break;
+            case TAG_CSV_ZCZ: out += L + "," + std::to_string(h.psl) + "," + std::to_string(h.extra) + ","; break;
+            case TAG_OPT:
+            case TAG_SZCP:
+            case TAG_NEAR_MID: out += std::string(TYPE[h.tag]) + ",L=" + L + ",Mid=" + std::to_string(h.extra) + ","; break;
+            case TAG_PQCP:
+            case TAG_NEAR_PEAKS:
+                out += std::string(TYPE[h.tag]) + ",L=" + L + ",Max=" + std::to_string(h.psl) + ",Peaks=" +
+                       std::to_string(h.peaks) + ",";
+                break;
+            default: break;
+        }
+        append_chars(a, h.L, out);
+        out += ',';
+        append_chars(b, h.L, out);
+    }
+
+    /* =========================
+       Writer (append)
+       ========================= */
+    class Writer {
+    public:
+        // 檔案不存在或為空時先寫 FileHeader
+        bool open(const std::string& path, bool truncate = false) {
+            close();
+            f_ = std::fopen(path.c_str(), truncate ? "wb" : "ab");
+            if (!f_) return false;
+            std::fseek(f_, 0, SEEK_END);
+            if (std::ftell(f_) == 0) {
+                FileHeader fh;
+                std::memcpy(fh.magic, MAGIC, sizeof(MAGIC));
+                fh.version = VERSION;
+                fh.record_header_bytes = sizeof(RecordHeader);
+                std::fwrite(&fh, sizeof(fh), 1, f_);
+            }
+            return true;
+        }
+
+        // timestamp < 0: 使用目前時間
+        void write(Record& r, int64_t timestamp = -1) {
+            r.h.timestamp = (timestamp < 0) ? (int64_t)std::time(nullptr) : timestamp;
+            r.h.L = (uint16_t)r.A.size();
+            r.h.words = words_for(r.h.L);
+            buf_.resize(2 * (size_t)r.h.words);
+            pack(r.A, buf_.data());
+            pack(r.B, buf_.data() + r.h.words);
+            std::fwrite(&r.h, sizeof(RecordHeader), 1, f_);
+            std::fwrite(buf_.data(), sizeof(uint64_t), buf_.size(), f_);
+        }
+
+        // 原文行 (不含換行) 存成 TAG_TEXT: 文字接在 RecordHeader 後，補零到 2 * words 個 uint64_t
+        void write_text(const char* p, size_t n) {
+            RecordHeader h{};
+            h.tag = TAG_TEXT;
+            h.psl = -1;
+            h.peaks = -1;
+            h.extra = (int32_t)n;
+            h.words = (uint32_t)((n + 15) / 16);
+            buf_.assign(2 * (size_t)h.words, 0);
+            if (n) std::memcpy(buf_.data(), p, n);
+            std::fwrite(&h, sizeof(RecordHeader), 1, f_);
+            std::fwrite(buf_.data(), sizeof(uint64_t), buf_.size(), f_);
+        }
+
+        // 已經是 packed 的 A、B (h.L / h.words 由呼叫端填好)
+        void write_packed(RecordHeader h, const uint64_t* a, const uint64_t* b, int64_t timestamp = -1) {
+            h.timestamp = (timestamp < 0) ? (int64_t)std::time(nullptr) : timestamp;
+            std::fwrite(&h, sizeof(RecordHeader), 1, f_);
+            std::fwrite(a, sizeof(uint64_t), h.words, f_);
+            std::fwrite(b, sizeof(uint64_t), h.words, f_);
+        }
+
+        void flush() { if (f_) std::fflush(f_); }
+        void close() {
+            if (f_) std::fclose(f_);
+            f_ = nullptr;
+        }
+        ~Writer() { close(); }
+
+    private:
+        std::FILE* f_ = nullptr;
+        std::vector<uint64_t> buf_;
+    };
+
+    /* =========================
+       Zero-Copy Reader (mmap)
+       ========================= */
+    struct RecordView {
+        const RecordHeader* h;
+        const uint64_t* a;
+        const uint64_t* b;
+    };
+
+    class Reader {
+    public:
+        bool open(const std::string& path) {
+            if (!file_.open(path) || file_.size() < sizeof(FileHeader)) return false;
+            const FileHeader* fh = file_.as<FileHeader>();
+            return std::memcmp(fh->magic, MAGIC, sizeof(MAGIC)) == 0 && fh->version >= 1 &&
+                   fh->version <= VERSION && fh->record_header_bytes == sizeof(RecordHeader);
+        }
+
+        // fn(const RecordView&)，只走訪結果 (略過 TAG_TEXT)；回傳結果筆數
+        template <typename F>
+        size_t for_each(F&& fn) const {
+            return for_each_raw([&](const RecordView& v) {
+                if (v.h->tag == TAG_TEXT) return false;
+                fn(v);
+                return true;
+            });
+        }
+
+        // 所有記錄 (含 TAG_TEXT)；fn 回傳 true 的才計數。尾端寫到一半的 record 會被略過
+        template <typename F>
+        size_t for_each_raw(F&& fn) const {
+            const char* p = file_.data() + sizeof(FileHeader);
+            const char* end = file_.data() + file_.size();
+            size_t n = 0;
+            while ((size_t)(end - p) >= sizeof(RecordHeader)) {
+                const RecordHeader* h = reinterpret_cast<const RecordHeader*>(p);
+                size_t bytes = sizeof(RecordHeader) + 2 * (size_t)h->words * sizeof(uint64_t);
+                if ((size_t)(end - p) < bytes) break;
+                const uint64_t* a = reinterpret_cast<const uint64_t*>(p + sizeof(RecordHeader));
+                if (fn(RecordView{ h, a, a + h->words })) n++;
+                p += bytes;
+            }
+            return n;
+        }
+
+        size_t size_bytes() const { return file_.size(); }
+
+    private:
+        MappedFile file_;
+    };
+
+    inline bool is_binary_file(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        char m[8] = {};
+        size_t n = std::fread(m, 1, sizeof(m), f);
+        std::fclose(f);
+        return n == sizeof(m) && std::memcmp(m, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    /* =========================
+       Converters
+       ========================= */
+    // 文字 -> 二進位；回傳寫入的結果筆數 (-1: 開檔失敗)。
+    // 標頭 / 註解，以及 format_line 無法逐字還原的行都存成 TAG_TEXT，轉回文字時原樣輸出
+    inline long long text_to_binary(const std::string& in_path, const std::string& out_path) {
+        MappedFile in;
+        if (!in.open(in_path)) return -1;
+        Writer w;
+        if (!w.open(out_path, true)) return -1;
+        long long n = 0;
+        TextRecord t;
+        std::vector<uint64_t> a, b;
+        std::string back;
+        PacpParse::LineScanner lines(in.data(), in.data() + in.size());
+        const char* lb;
+        const char* le;
+        while (lines.next(lb, le)) {
+            if (!parse_text(lb, le, t)) {
+                w.write_text(lb, le - lb);
+                continue;
+            }
+            a.resize(t.h.words);
+            b.resize(t.h.words);
+            PacpParse::pack_pm(t.a, t.h.L, a.data());
+            PacpParse::pack_pm(t.b, t.h.L, b.data());
+            format_line(t.h, a.data(), b.data(), back);
+            if (back.size() != (size_t)(le - lb) || std::memcmp(back.data(), lb, back.size()) != 0) {
+                w.write_text(lb, le - lb);
+                continue;
+            }
+            w.write_packed(t.h, a.data(), b.data(), 0);
+            n++;
+        }
+        return n;
+    }
+
+    // 二進位 -> 文字；回傳寫出的結果筆數 (-1: 開檔失敗或格式不符)，TAG_TEXT 記錄原樣寫回
+    inline long long binary_to_text(const std::string& in_path, const std::string& out_path) {
+        Reader rd;
+        if (!rd.open(in_path)) return -1;
+        std::FILE* f = std::fopen(out_path.c_str(), "wb");
+        if (!f) return -1;
+        std::string line;
+        size_t n = rd.for_each_raw([&](const RecordView& v) {
+            bool text = (v.h->tag == TAG_TEXT);
+            if (text) line.assign(reinterpret_cast<const char*>(v.a), (size_t)v.h->extra);
+            else format_line(*v.h, v.a, v.b, line);
+            line += '\n';
+            std::fwrite(line.data(), 1, line.size(), f);
+            return !text;
+        });
+        std::fclose(f);
+        return (long long)n;
+    }
+}
+
+#endif
@@ -0,0 +1,439 @@
+// ==========================================
+// Filename: pacp_sink.h
+// Optimization: Asynchronous Batched Result Sink (Lock-free MPSC + Writer Thread)
+// ==========================================
+//
+// 以前每找到一筆就 ensure_file_dir -> ofstream(app) -> 逐字元寫 -> close，
+// I/O 卡在搜尋執行緒上，多個 worker 行程同時 append 同一檔時還會交錯。
+// 改成:
+//   - 搜尋端只把整行字串推進 lock-free MPSC 佇列 (Vyukov intrusive queue)，不碰檔案
+//   - 專用 writer thread 每 flush_ms 醒來一次，把佇列清空、依檔案合併成一塊，
+//     每個檔案一次 write() (O_APPEND，整批原子地接在檔尾，不同行程不會交錯)
+//   - 每 fsync_ms 對寫過的檔案 fsync 一次 (0 = 不 fsync)
+// 環境變數 PACP_SINK_FLUSH_MS / PACP_SINK_FSYNC_MS 可覆寫預設值。
+// 可選的 done callback 在該行寫入後於 writer thread 上執行 (例如 CanonIndex::commit)；
+// 可選的 BatchHook 在整批 callback 跑完後，每個不同的 ctx 只呼叫一次 (例如 CanonIndex::sync)。
+// 寫入失敗 (開檔失敗 / write 錯誤 / 寫一半) 時，沒寫出去的部分留在緩衝區，下一輪重試，
+// 錯誤印到 stderr (每次由正常轉為失敗、或恢復時各一次)；done callback 只在該行的 bytes 真的寫出後才執行。
+// 不再使用的輸出檔 (例如 pacpd 每個 job 的串流檔) 以 release(path) 寫完、關檔，channel id 回收再用。
+
+#ifndef PACP_SINK_H
+#define PACP_SINK_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+class ResultSink {
+public:
+    struct Config {
+        int flush_ms = 50;
+        int fsync_ms = 1000;
+    };
+
+    // 每批結束時的收尾: fn(ctx)，同一批內相同 ctx 只呼叫一次
+    struct BatchHook {
+        void (*fn)(void*);
+        void* ctx;
+    };
+
+    static Config default_config() {
+        Config c;
+        if (const char* v = std::getenv("PACP_SINK_FLUSH_MS")) c.flush_ms = std::max(1, std::atoi(v));
+        if (const char* v = std::getenv("PACP_SINK_FSYNC_MS")) c.fsync_ms = std::max(0, std::atoi(v));
+        return c;
+    }
+
+    explicit ResultSink(Config cfg = default_config()) : cfg_(cfg) {
+        head_.store(&stub_, std::memory_order_relaxed);
+        tail_ = &stub_;
+        writer_ = std::thread([this] { run(); });
+    }
+    ~ResultSink() { close(); }
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    // 整個行程共用一個 sink (main 結束時解構，會把剩下的資料寫完)
+    static ResultSink& shared() {
+        static ResultSink sink;
+        return sink;
+    }
+
+    // 註冊輸出檔 (順便建立目錄)，回傳 channel id；同一路徑回傳同一個 id
+    int channel(const std::string& path) {
+        std::lock_guard<std::mutex> lk(chan_mu_);
+        for (size_t i = 0; i < paths_.size(); ++i) if (paths_[i] == path) return (int)i;
+        try {
+            std::filesystem::path p(path);
+            if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+        } catch (...) {}
+        if (!free_.empty()) {
+            int c = free_.back();
+            free_.pop_back();
+            paths_[c] = path;
+            return c;
+        }
+        paths_.push_back(path);
+        return (int)paths_.size() - 1;
+    }
+
+    // 不再寫入 path 時呼叫: flush 後由 writer thread 關檔並回收 channel id。
+    // 呼叫端保證之後不再 submit 到這個 path / 舊的 id；回傳值同 flush()
+    bool release(const std::string& path) {
+        int chan = -1;
+        {
+            std::lock_guard<std::mutex> lk(chan_mu_);
+            for (size_t i = 0; i < paths_.size(); ++i) if (paths_[i] == path) chan = (int)i;
+        }
+        if (chan < 0) return true;
+        bool ok = flush();
+        std::unique_lock<std::mutex> lk(mu_);
+        release_.push_back(chan);
+        wake_ = true;
+        cv_.notify_all();
+        done_cv_.wait(lk, [&] {
+            return std::find(release_.begin(), release_.end(), chan) == release_.end() || !writer_.joinable();
+        });
+        return ok;
+    }
+
+    // 搜尋端呼叫: 不阻塞、不做 I/O。line 應包含結尾的 '\n'
+    void submit(int chan, std::string line, std::function<void()> done = {}, BatchHook hook = BatchHook()) {
+        Node* n = new Node;
+        n->chan = chan;
+        n->data = std::move(line);
+        n->done = std::move(done);
+        n->hook = hook;
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        Node* prev = head_.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    void submit(const std::string& path, std::string line, std::function<void()> done = {}, BatchHook hook = BatchHook()) {
+        submit(channel(path), std::move(line), std::move(done), hook);
+    }
+
+    // 等到目前為止送出的資料都處理過 (寫進檔案，或因寫入失敗留在緩衝區等重試)；
+    // 回傳 false 表示還有資料卡在失敗的檔案上 (錯誤已印到 stderr)
+    bool flush() {
+        uint64_t target = submitted_.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lk(mu_);
+        wake_ = true;
+        cv_.notify_all();
+        done_cv_.wait(lk, [&] { return written_ + held_ >= target || !writer_.joinable(); });
+        return held_ == 0;
+    }
+
+    void close() {
+        if (!writer_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+        done_cv_.notify_all();
+    }
+
+    // '+'/'-' 字串 (x > 0 為 '+')
+    template <class V>
+    static void append_pm(std::string& out, const V& v) {
+        for (auto x : v) out += (x > 0) ? '+' : '-';
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        int chan = 0;
+        std::string data;
+        std::function<void()> done;
+        BatchHook hook = BatchHook();
+    };
+
+    // 緩衝區中每一行的結尾位置與它的 callback；寫出的 bytes 涵蓋 end 才算寫完
+    struct Pending {
+        size_t end;
+        std::function<void()> done;
+        BatchHook hook;
+    };
+
+    struct Out {
+        int fd = -1;
+        std::string buf;
+        std::vector<Pending> waiting;
+        bool dirty = false;
+        bool failed = false;          // 上一次寫入失敗 (只在狀態改變時印訊息)
+    };
+
+    Config cfg_;
+    Node stub_;
+    std::atomic<Node*> head_;
+    Node* tail_;                       // 只有 writer thread 使用
+    std::atomic<uint64_t> submitted_{ 0 };
+
+    std::mutex chan_mu_;
+    std::vector<std::string> paths_;   // 已 release 的為空字串
+    std::vector<int> free_;            // 可重用的 channel id
+
+    std::mutex mu_;
+    std::condition_variable cv_, done_cv_;
+    bool stop_ = false, wake_ = false;
+    uint64_t written_ = 0;            // 已寫進檔案的行數
+    uint64_t held_ = 0;               // 寫入失敗、留在緩衝區等重試的行數
+    std::vector<int> release_;         // 等 writer 關檔的 channel (持有 mu_)
+    std::thread writer_;
+
+    // Vyukov MPSC pop: 生產者 exchange 完 head_ 但還沒接上 next 的瞬間會回傳 nullptr，下一輪再拿
+    Node* pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return nullptr;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) return nullptr;
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(&stub_, std::memory_order_acq_rel);
+        prev->next.store(&stub_, std::memory_order_release);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    static int open_append(const std::string& path) {
+#ifdef _WIN32
+        return ::_open(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, 0644);
+#else
+        return ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+    }
+
+    // 回傳實際寫出的 bytes；小於 s.size() 時 err 為 errno (0 表示 write 回傳 0)
+    static size_t write_all(int fd, const std::string& s, int& err) {
+        const char* p = s.data();
+        size_t left = s.size();
+        err = 0;
+        while (left > 0) {
+#ifdef _WIN32
+            int n = ::_write(fd, p, (unsigned)left);
+#else
+            ssize_t n = ::write(fd, p, left);
+#endif
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                err = (n < 0) ? errno : 0;
+                break;
+            }
+            p += n;
+            left -= (size_t)n;
+        }
+        return s.size() - left;
+    }
+
+    std::string path_of(size_t c) {
+        std::lock_guard<std::mutex> lk(chan_mu_);
+        return paths_[c];
+    }
+
+    void report(Out& o, size_t c, const char* what, int err) {
+        if (o.failed) return;
+        o.failed = true;
+        std::fprintf(stderr, "[ResultSink] %s %s: %s (%zu lines kept, will retry)\n", what, path_of(c).c_str(),
+                     err ? std::strerror(err) : "short write", o.waiting.size());
+    }
+
+    // 把 o.buf 寫出去: 已寫完的行交出 callback / hook，沒寫完的留在緩衝區；回傳寫完的行數
+    uint64_t drain(Out& o, size_t c, std::vector<std::function<void()>>& callbacks, std::vector<BatchHook>& hooks) {
+        if (o.buf.empty()) return 0;
+        if (o.fd < 0) {
+            o.fd = open_append(path_of(c));
+            if (o.fd < 0) {
+                report(o, c, "cannot open", errno);
+                return 0;
+            }
+        }
+        int err = 0;
+        size_t n = write_all(o.fd, o.buf, err);
+        if (n > 0) o.dirty = true;
+
+        size_t k = 0;
+        for (; k < o.waiting.size() && o.waiting[k].end <= n; ++k) {
+            Pending& w = o.waiting[k];
+            if (w.done) callbacks.push_back(std::move(w.done));
+            if (w.hook.fn && std::none_of(hooks.begin(), hooks.end(),
+                                          [&](const BatchHook& h) { return h.ctx == w.hook.ctx; })) {
+                hooks.push_back(w.hook);
+            }
+        }
+        o.waiting.erase(o.waiting.begin(), o.waiting.begin() + k);
+        for (Pending& w : o.waiting) w.end -= n;
+        o.buf.erase(0, n);
+
+        if (!o.buf.empty()) {
+            report(o, c, "write failed on", err);
+            // fd 可能已壞掉 (例如檔案被移走的網路磁碟)，下一輪重新開
+            close_fd(o.fd);
+            o.fd = -1;
+        } else if (o.failed) {
+            o.failed = false;
+            std::fprintf(stderr, "[ResultSink] %s: writes resumed\n", path_of(c).c_str());
+        }
+        return k;
+    }
+
+    static void sync_fd(int fd) {
+#ifdef _WIN32
+        ::_commit(fd);
+#else
+        ::fsync(fd);
+#endif
+    }
+
+    static void close_fd(int fd) {
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    void run() {
+        std::vector<Out> outs;
+        std::vector<std::function<void()>> callbacks;
+        std::vector<BatchHook> hooks;
+        auto last_sync = std::chrono::steady_clock::now();
+        int final_retries = 0;
+
+        while (true) {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait_for(lk, std::chrono::milliseconds(cfg_.flush_ms), [&] { return stop_ || wake_; });
+                wake_ = false;
+                stopping = stop_;
+            }
+
+            // 1. 清空佇列，依檔案合併
+            uint64_t batch = 0;
+            while (true) {
+                Node* n = pop();
+                if (!n) {
+                    // 生產者可能正在接 next，停機時要等它接好
+                    if (stopping && batch + written_ + held_ < submitted_.load(std::memory_order_relaxed)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    break;
+                }
+                if ((size_t)n->chan >= outs.size()) outs.resize(n->chan + 1);
+                Out& o = outs[n->chan];
+                o.buf += n->data;
+                o.waiting.push_back({ o.buf.size(), std::move(n->done), n->hook });
+                batch++;
+                delete n;
+            }
+
+            // 2. 每個檔案一次 write() (上一輪失敗留下的也一起重試)；寫完的行才跑 callback
+            uint64_t done_lines = 0;
+            for (size_t c = 0; c < outs.size(); ++c) done_lines += drain(outs[c], c, callbacks, hooks);
+            for (auto& fn : callbacks) fn();
+            callbacks.clear();
+            for (const BatchHook& h : hooks) h.fn(h.ctx);
+            hooks.clear();
+
+            // 2b. release: 關檔、回收 channel (寫不出去的行在這裡放棄並回報)
+            std::vector<int> closing;
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                closing = release_;
+            }
+            uint64_t dropped = 0;
+            for (int c : closing) {
+                if ((size_t)c >= outs.size()) outs.resize(c + 1);
+                Out& o = outs[c];
+                if (!o.waiting.empty()) {
+                    std::fprintf(stderr, "[ResultSink] %zu lines for %s dropped on release\n", o.waiting.size(),
+                                 path_of(c).c_str());
+                    dropped += o.waiting.size();
+                }
+                if (o.fd >= 0) {
+                    if (o.dirty && cfg_.fsync_ms > 0) sync_fd(o.fd);
+                    close_fd(o.fd);
+                }
+                o = Out();
+                std::lock_guard<std::mutex> lk(chan_mu_);
+                paths_[c].clear();
+                free_.push_back(c);
+            }
+            uint64_t held = 0;
+            for (const Out& o : outs) held += o.waiting.size();
+
+            // 3. 定期 fsync
+            auto now = std::chrono::steady_clock::now();
+            bool sync_due = cfg_.fsync_ms > 0 &&
+                std::chrono::duration_cast<std::chrono::milliseconds>(now - last_sync).count() >= cfg_.fsync_ms;
+            if (sync_due || stopping) {
+                for (Out& o : outs) {
+                    if (o.fd >= 0 && o.dirty && cfg_.fsync_ms > 0) sync_fd(o.fd);
+                    o.dirty = false;
+                }
+                last_sync = now;
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                written_ += done_lines + dropped;
+                held_ = held;
+                if (!closing.empty()) {
+                    release_.erase(std::remove_if(release_.begin(), release_.end(), [&](int c) {
+                        return std::find(closing.begin(), closing.end(), c) != closing.end();
+                    }), release_.end());
+                }
+            }
+            done_cv_.notify_all();
+            if (stopping) {
+                // 停機時還有寫不出去的資料: 再試幾輪才放棄
+                if (held == 0 || ++final_retries > 3) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(cfg_.flush_ms));
+            }
+        }
+        for (size_t c = 0; c < outs.size(); ++c) {
+            if (outs[c].fd >= 0) close_fd(outs[c].fd);
+            if (!outs[c].waiting.empty()) {
+                std::fprintf(stderr, "[ResultSink] %zu lines for %s could not be written\n", outs[c].waiting.size(),
+                             path_of(c).c_str());
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,201 @@
+// ==========================================
+// Filename: pacp_stats.h
+// Optimization: Shared-Memory Live Statistics (mmap Segment + Seqlock)
+// ==========================================
+//
+// 以前 worker 每 50000 次迭代就 truncate + 重寫一次 status 檔，監控腳本再用 read / awk / grep 去讀，
+// 還會讀到寫到一半的內容 ("READING...")。
+// 改成所有 worker 共用一個 MAP_SHARED 的檔案區段 (例如 <L>_PACP/Workers/live_stats.shm):
+//   Header  : magic、種類 (PQCP / Goal 2)、L、slot 數
+//   Slot[i] : worker i 的計數器，一個 slot 佔兩條 cache line，彼此不共享
+// 寫入端 (hot loop) 只做幾個 relaxed atomic store，沒有 syscall；
+// 讀取端 (bin/dashboard) 用 seqlock 協定: seq 為奇數或前後不一致就重讀，永遠不會看到撕裂的數值。
+
+#ifndef PACP_STATS_H
+#define PACP_STATS_H
+
+#include "pacp_mmap.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LiveStats {
+
+    const char MAGIC[8] = { 'P', 'A', 'C', 'P', 'L', 'I', 'V', '1' };
+    const int MAX_SLOTS = 256;
+
+    enum Kind : uint32_t { KIND_PQCP = 1, KIND_GOAL2 = 2 };
+
+    // 一個 worker 的快照 (metric: PQCP 為 peak 數，Goal 2 為 mid 值)
+    struct Counters {
+        int64_t iter = 0;
+        int64_t restarts = 0;
+        int64_t viol = 0;
+        int64_t metric = 0;
+        int64_t found = 0;
+        int64_t near = 0;
+        int64_t elapsed_s = 0;
+        int64_t heartbeat_ms = 0;   // system_clock epoch ms，0 = slot 未使用
+    };
+    const int NUM_FIELDS = sizeof(Counters) / sizeof(int64_t);
+
+    struct Header {
+        char magic[8];
+        uint32_t kind;
+        uint32_t L;
+        uint32_t slots;
+        uint32_t reserved;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq;
+        std::atomic<uint32_t> pid;
+        std::atomic<int64_t> v[NUM_FIELDS];
+        char pad[128 - 8 - NUM_FIELDS * 8];
+    };
+    static_assert(sizeof(Slot) == 128, "Slot layout");
+    static_assert(std::atomic<int64_t>::is_always_lock_free, "shared-memory counters must be lock-free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory seq must be lock-free");
+
+    const size_t HEADER_BYTES = 64;
+    const size_t SEGMENT_BYTES = HEADER_BYTES + sizeof(Slot) * MAX_SLOTS;
+
+    inline int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    inline int current_pid() {
+#ifdef _WIN32
+        return (int)GetCurrentProcessId();
+#else
+        return (int)getpid();
+#endif
+    }
+
+    /* =========================
+       Writer (worker 端)
+       ========================= */
+    class Writer {
+    public:
+        ~Writer() { close(); }
+
+        // 建立或打開區段並佔用 slot (worker_id % MAX_SLOTS)；失敗時 publish 變成 no-op
+        bool open(const std::string& path, int worker_id, Kind kind, int L) {
+            close();
+#ifdef _WIN32
+            file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) return false;
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, 0, (DWORD)SEGMENT_BYTES, nullptr);
+            if (!mapping_) { close(); return false; }
+            base_ = (char*)MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, SEGMENT_BYTES);
+            if (!base_) { close(); return false; }
+#else
+            fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd_ < 0) return false;
+            struct stat st;
+            if (fstat(fd_, &st) != 0) { close(); return false; }
+            // 多個 worker 同時建立時都 truncate 成同一大小，新增的部分為 0
+            if ((size_t)st.st_size < SEGMENT_BYTES && ftruncate(fd_, SEGMENT_BYTES) != 0) { close(); return false; }
+            void* p = mmap(nullptr, SEGMENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED) { close(); return false; }
+            base_ = (char*)p;
+#endif
+            Header* h = reinterpret_cast<Header*>(base_);
+            h->kind = kind;
+            h->L = (uint32_t)L;
+            h->slots = MAX_SLOTS;
+            std::memcpy(h->magic, MAGIC, sizeof(MAGIC));   // magic 最後寫，讀取端看到 magic 就代表欄位齊了
+
+            slot_ = reinterpret_cast<Slot*>(base_ + HEADER_BYTES) + (worker_id % MAX_SLOTS);
+            slot_->pid.store((uint32_t)current_pid(), std::memory_order_relaxed);
+            return true;
+        }
+
+        // seqlock 寫入: seq 變奇數 -> 寫欄位 -> seq 變偶數
+        void publish(Counters c) {
+            if (!slot_) return;
+            c.heartbeat_ms = now_ms();
+            const int64_t* src = reinterpret_cast<const int64_t*>(&c);
+            uint32_t s = slot_->seq.load(std::memory_order_relaxed);
+            slot_->seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int i = 0; i < NUM_FIELDS; ++i) slot_->v[i].store(src[i], std::memory_order_relaxed);
+            slot_->seq.store(s + 2, std::memory_order_release);
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (base_) UnmapViewOfFile(base_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (base_) munmap(base_, SEGMENT_BYTES);
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+#endif
+            base_ = nullptr;
+            slot_ = nullptr;
+        }
+
+    private:
+        char* base_ = nullptr;
+        Slot* slot_ = nullptr;
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+    };
+
+    /* =========================
+       Reader (dashboard 端)
+       ========================= */
+    class Reader {
+    public:
+        // 區段還沒建立 (worker 還在啟動) 時回傳 false，稍後再試
+        bool open(const std::string& path) {
+            if (!map_.open(path) || map_.size() < SEGMENT_BYTES) {
+                map_.close();
+                return false;
+            }
+            return std::memcmp(header().magic, MAGIC, sizeof(MAGIC)) == 0;
+        }
+
+        const Header& header() const { return *map_.as<Header>(); }
+
+        // 一致的快照；slot 未使用 (或 worker 死在寫入途中) 時回傳 false
+        bool read(int slot, Counters& out, int* pid = nullptr) const {
+            const Slot* s = reinterpret_cast<const Slot*>(map_.data() + HEADER_BYTES) + slot;
+            int64_t* dst = reinterpret_cast<int64_t*>(&out);
+            for (int tries = 0; tries < 10000; ++tries) {
+                uint32_t s1 = s->seq.load(std::memory_order_acquire);
+                if (s1 & 1u) continue;
+                for (int i = 0; i < NUM_FIELDS; ++i) dst[i] = s->v[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s->seq.load(std::memory_order_relaxed) != s1) continue;
+                if (pid) *pid = (int)s->pid.load(std::memory_order_relaxed);
+                return out.heartbeat_ms != 0;
+            }
+            return false;
+        }
+
+    private:
+        MappedFile map_;
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define PACP_UTILS_H
 
 #include "pacp_core.h" 
+#include "pacp_results.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -117,31 +118,20 @@ inline void save_session_report(const std::string& base_filename, int L, const s
     outfile.close();
 }
 
+// [New] mmap + PacpResults::parse_text，只讀第一行的 A,B (L,PSL,A,B 屬於 result 格式，不接受)
 inline bool load_seed_csv(const std::string& filename, Seq& A, Seq& B) {
-    if (!fs::exists(filename)) return false;
-    std::ifstream infile(filename);
-    if (!infile.is_open()) return false;
-
-    std::string line;
-    if (std::getline(infile, line)) {
-        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
-        size_t comma = line.find(',');
-        if (comma == std::string::npos) return false;
-
-        std::string sA = line.substr(0, comma);
-        std::string sB = line.substr(comma + 1);
-
-        // 基本防呆：若讀到數字(L)開頭，表示格式錯誤 (屬於 result 格式)
-        if (!sA.empty() && std::isdigit(sA[0])) return false;
-
-        if (sA.empty() || sB.empty() || sA.length() != sB.length()) return false;
-        int L = sA.length();
-        A.resize(L); B.resize(L);
-        for(int i=0; i<L; ++i) A[i] = (sA[i] == '+') ? 1 : -1;
-        for(int i=0; i<L; ++i) B[i] = (sB[i] == '+') ? 1 : -1;
-        return true;
-    }
-    return false;
+    MappedFile m;
+    if (!m.open(filename) || m.size() == 0) return false;
+    PacpParse::LineScanner lines(m.data(), m.data() + m.size());
+    const char* b;
+    const char* e;
+    PacpResults::TextRecord t;
+    if (!lines.next(b, e) || !PacpResults::parse_text(b, e, t, false)) return false;
+    if (t.h.tag != PacpResults::TAG_PAIR) return false;
+    A.resize(t.h.L); B.resize(t.h.L);
+    PacpParse::decode_pm(t.a, t.h.L, A.data());
+    PacpParse::decode_pm(t.b, t.h.L, B.data());
+    return true;
 }
 
 #endif // PACP_UTILS_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+// ==========================================
+// Filename: pacp_verify.h
+// Optimization: Packed Periodic ACF (XOR + popcount) + One-Pass Pair Classification
+// ==========================================
+//
+// 以前每個篩選腳本各算一次 ACF: optimal1/2.sh 用 Python 三層迴圈、szcp.cpp 逐 lag 重新解析字串，
+// optimal3.sh 甚至只 grep "Max=4" / "Peaks=2" 而不驗證。
+// 這裡序列用 PacpResults 的 packed 格式 (bit i = 1 表示 s[i] = -1)，長度不限:
+//   rho(u) = L - 2 * popcount( s XOR rot(s, u) )
+// rot(s, u) 從「s 接 s」的 2L bit 緩衝區取視窗，每個 u 只要 L/64 個 word 運算；
+// S(u) = rho_A(u) + rho_B(u) 對稱 (S(u) = S(L-u))，只算 u = 1..L/2。
+// 一組 S 算完後一次判定所有類別 (與各 optimizer 的存檔條件相同):
+//   ODD_OPT  : L 奇數，所有 |S(u)| == 2                        (Goal 1)
+//   EVEN_OPT : L 偶數，S(u) == 0 (u != L/2) 且 |S(L/2)| == 4    (Goal 2 OPT)
+//   PQCP     : 所有 |S(u)| <= 4 且 peaks == 2                  (Goal 3, optimizer_pqcp)
+//   NEAR     : 非上述，且 奇數 PSL <= 6 / 偶數 ZCZ 完整但 |S(L/2)| > 4 / 偶數 PSL <= 4 且 peaks <= 4
+//   SZCP     : 零相關區寬度 Z (S(u) == 0, 1 <= u < Z) >= zcz_min
+// peaks 的算法同 optimizer_pqcp: u 與 L-u 各算一次，偶數 L 的 u = L/2 只算一次。
+
+#ifndef PACP_VERIFY_H
+#define PACP_VERIFY_H
+
+#include "pacp_results.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+namespace Verify {
+
+    enum Class : uint32_t {
+        ODD_OPT = 1u << 0,
+        EVEN_OPT = 1u << 1,
+        PQCP = 1u << 2,
+        NEAR = 1u << 3,
+        SZCP = 1u << 4
+    };
+
+    struct Profile {
+        int L = 0;
+        int psl = 0;        // max |S(u)|, u != 0
+        int peaks = 0;      // S(u) != 0 的個數 (u = 1..L-1)
+        int zcz = 0;        // 零相關區寬度 Z；整條都為 0 時為 L
+        int out_zone = 0;   // |S(Z)| (Z == L 時為 0)
+        uint32_t classes = 0;
+    };
+
+    inline Profile profile(const std::vector<int>& sum, int L, int zcz_min) {
+        Profile p;
+        p.L = L;
+        p.zcz = L;
+        int half = L / 2;
+        bool all_two = true, zone_ok = true;
+        for (int u = 1; u <= half; ++u) {
+            int v = std::abs(sum[u]);
+            int weight = (u == half && L % 2 == 0) ? 1 : 2;
+            if (v > p.psl) p.psl = v;
+            if (v != 0) p.peaks += weight;
+            if (v != 2) all_two = false;
+            if (v != 0 && p.zcz == L) {
+                p.zcz = u;
+                p.out_zone = v;
+            }
+            if (u < half && v != 0) zone_ok = false;
+        }
+
+        bool odd = (L % 2 != 0);
+        int mid = odd ? 0 : std::abs(sum[half]);
+        if (odd && all_two) p.classes |= ODD_OPT;
+        if (!odd && zone_ok && mid == 4) p.classes |= EVEN_OPT;
+        if (p.psl <= 4 && p.peaks == 2) p.classes |= PQCP;
+        if (!(p.classes & (ODD_OPT | EVEN_OPT | PQCP))) {
+            bool near = odd ? (p.psl <= 6) : ((zone_ok && mid > 4) || (p.psl <= 4 && p.peaks <= 4));
+            if (near) p.classes |= NEAR;
+        }
+        if (p.zcz >= zcz_min) p.classes |= SZCP;
+        return p;
+    }
+
+    // 每個執行緒一份，重複使用緩衝區
+    class Kernel {
+    public:
+        // sum[u] = S(u)，u = 0..L/2
+        void pair_acf(const uint64_t* a, const uint64_t* b, int L, std::vector<int>& sum) {
+            int half = L / 2;
+            sum.assign(half + 1, 2 * L);
+            load(a, L, ext_a_);
+            load(b, L, ext_b_);
+            int W = (int)PacpResults::words_for(L);
+            uint64_t last_mask = (L & 63) ? ((1ULL << (L & 63)) - 1) : ~0ULL;
+            for (int u = 1; u <= half; ++u) {
+                int d = 0;
+                for (int j = 0; j < W; ++j) {
+                    uint64_t m = (j == W - 1) ? last_mask : ~0ULL;
+                    d += __builtin_popcountll((ext_a_[j] ^ window(ext_a_, u + 64 * j)) & m);
+                    d += __builtin_popcountll((ext_b_[j] ^ window(ext_b_, u + 64 * j)) & m);
+                }
+                sum[u] = 2 * L - 2 * d;
+            }
+        }
+
+        Profile classify(const uint64_t* a, const uint64_t* b, int L, int zcz_min) {
+            pair_acf(a, b, L, sum_);
+            return profile(sum_, L, zcz_min);
+        }
+
+        const std::vector<int>& last_sum() const { return sum_; }
+
+    private:
+        std::vector<uint64_t> ext_a_, ext_b_;
+        std::vector<int> sum_;
+
+        // ext = s 接 s (2L bits)，多留一個 word 給 window 讀 k+1
+        static void load(const uint64_t* s, int L, std::vector<uint64_t>& ext) {
+            int W = (int)PacpResults::words_for(L);
+            ext.assign(PacpResults::words_for(2 * L) + 1, 0);
+            std::memcpy(ext.data(), s, W * sizeof(uint64_t));
+            if (L & 63) ext[W - 1] &= (1ULL << (L & 63)) - 1;
+            int k = L >> 6, r = L & 63;
+            for (int j = 0; j < W; ++j) {
+                uint64_t w = s[j];
+                if (j == W - 1 && (L & 63)) w &= (1ULL << (L & 63)) - 1;
+                ext[k + j] |= w << r;
+                if (r) ext[k + j + 1] |= w >> (64 - r);
+            }
+        }
+
+        static uint64_t window(const std::vector<uint64_t>& ext, int pos) {
+            int k = pos >> 6, r = pos & 63;
+            return r ? (ext[k] >> r) | (ext[k + 1] << (64 - r)) : ext[k];
+        }
+    };
+}
+
+#endif
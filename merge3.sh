@@ -2,29 +2,8 @@
 # 檔名: merge3.sh
 # 功能: T2 系列 (Goal 3 PQCP) 依照 L 分開整合
 # 輸出: ./results-g/L<L>_T2_merged.txt
+# [New] 改由 bin/merge 處理: 平行讀檔 + canonical 指紋去重 (循環位移 / 取負 / A,B 交換都算同一筆)
+#       額外參數直接轉給 bin/merge，例如 ./merge3.sh --binary
 
-SOURCE_DIR="./results-c/results by computer"
-OUTPUT_DIR="./results-g"
-mkdir -p "$OUTPUT_DIR"
-
-echo "啟動 T2 系列分流整合 (By Length)..."
-
-# 1. 找出所有 PQCP 檔，提取 L
-# 路徑範例: .../46_PACP/46_PQCP.txt -> 提取 46
-find "$SOURCE_DIR" -path "*N96141066-T2-*/*_PACP/*_PQCP.txt" | \
-    sed -E 's/.*\/([0-9]+)_PQCP\.txt/\1/' | sort -n | uniq | while read L; do
-
-    OUT_FILE="${OUTPUT_DIR}/L${L}_T2_merged.txt"
-    
-    echo -ne "正在處理 L=${L} (PQCP) ... "
-    
-    # 2. 針對這個 L 合併
-    find "$SOURCE_DIR" -type f -path "*N96141066-T2-*/${L}_PACP/${L}_PQCP.txt" -print0 | \
-        xargs -0 cat | \
-        sort | uniq > "$OUT_FILE"
-        
-    COUNT=$(wc -l < "$OUT_FILE")
-    echo "完成 (筆數: $COUNT)"
-done
-
-echo "✅ T2 整合完畢。"
\ No newline at end of file
+if [ -f "./bin/merge.exe" ]; then MERGE="./bin/merge.exe"; else MERGE="./bin/merge"; fi
+"$MERGE" t2 --src "./results-c/results by computer" --out "./results-g" "$@"
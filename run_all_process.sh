@@ -35,13 +35,15 @@ run_script "merge3.sh"  "T2 系列整合 (By Length)"
 
 # --- 階段二：篩選與驗證 (依照 L 驗證) ---
 echo -e "\n${BLUE}--- 階段二：篩選與驗證 (Filter) ---${NC}"
-run_script "optimal1.sh" "Goal 1 驗證 (Odd)"
-run_script "optimal2.sh" "Goal 2 驗證 (Even)"
-run_script "optimal3.sh" "Goal 3 篩選 (PQCP)"
-
-# --- 階段三：生成報表 (新增) ---
-echo -e "\n${BLUE}--- 階段三：統計報表 (Report) ---${NC}"
-run_script "summary.sh"  "生成最終統計報表"
+# [New] bin/classify 一次算完每筆 ACF，同時分出 Goal 1 / Goal 2 / PQCP / Near / SZCP 並寫出報表
+#       (取代 optimal1.sh、optimal2.sh、optimal3.sh、summary.sh 四個步驟)
+echo -e "\n${YELLOW}[$(date +%H:%M:%S)] 執行: 驗證與分類 (Goal 1/2/3, Near, SZCP) ...${NC}"
+if [ -f "./bin/classify.exe" ]; then CLASSIFY="./bin/classify.exe"; else CLASSIFY="./bin/classify"; fi
+if [ -x "$CLASSIFY" ]; then
+    "$CLASSIFY" --src "./results-g" --out "./results-final" --report "final_report.txt"
+else
+    echo -e "${RED}❌ 錯誤：找不到 $CLASSIFY (請先 make)${NC}"; exit 1
+fi
 
 # --- 結束 ---
 END_TOTAL=$(date +%s)
@@ -0,0 +1,95 @@
+// ==========================================
+// Filename: aps_canon.h
+// Optimization: Packed Canonical Form (Shift x Reversal x Negation)
+// ==========================================
+//
+// aps_filter 的等價類去重核心，aps_sched / aps_stream 共用。
+// 序列壓成 uint64_t: s[0] 在最高位，'+' = 0、'-' = 1，
+// 所以整數大小順序 == 字串字典序 ('+' < '-')，與舊版 string 的 canonical 結果相同。
+// 等價變換: 循環位移 x 反轉 x 取負，四個變體各做 L 次 O(1) 的 word rotate 取最小。
+// L > 64 放不進一個 word，改用 canonical_string (同樣的變換、同樣的順序，直接比字串)。
+
+#ifndef APS_CANON_H
+#define APS_CANON_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+
+typedef std::pair<uint64_t, uint64_t> PairKey;
+
+inline bool pack_seq(const char* p, int len, uint64_t& out) {
+    if (len <= 0 || len > 64) return false;
+    uint64_t w = 0;
+    for (int i = 0; i < len; ++i) w = (w << 1) | (p[i] == '-' ? 1ULL : 0ULL);
+    out = w;
+    return true;
+}
+
+inline std::string unpack_seq(uint64_t w, int len) {
+    std::string s(len, '+');
+    for (int i = 0; i < len; ++i) if ((w >> (len - 1 - i)) & 1ULL) s[i] = '-';
+    return s;
+}
+
+inline uint64_t reverse_bits(uint64_t w, int len) {
+    uint64_t r = 0;
+    for (int i = 0; i < len; ++i) r |= ((w >> i) & 1ULL) << (len - 1 - i);
+    return r;
+}
+
+inline uint64_t least_rotation(uint64_t w, int len, uint64_t mask) {
+    uint64_t best = w;
+    for (int k = 1; k < len; ++k) {
+        w = ((w << 1) | (w >> (len - 1))) & mask;
+        if (w < best) best = w;
+    }
+    return best;
+}
+
+// Handles: Cyclic Shift, Reversal, and Negation
+inline uint64_t get_canonical(uint64_t w, int len) {
+    uint64_t mask = (len >= 64) ? ~0ULL : ((1ULL << len) - 1);
+    uint64_t r = reverse_bits(w, len);
+    uint64_t best = least_rotation(w, len, mask);
+    best = std::min(best, least_rotation(w ^ mask, len, mask));
+    best = std::min(best, least_rotation(r, len, mask));
+    best = std::min(best, least_rotation(r ^ mask, len, mask));
+    return best;
+}
+
+// Sort pair to handle {A, B} == {B, A}
+inline PairKey canonical_pair(uint64_t a, uint64_t b) {
+    return a < b ? PairKey(a, b) : PairKey(b, a);
+}
+
+/* =========================
+   String Fallback (L > 64)
+   =========================
+   與 get_canonical 相同的等價類代表元，以 '+'/'-' 字串表示 (非 '-' 一律視為 '+')。
+   四個變體各接成兩倍長，L 個起點以 memcmp 取最小: O(L^2)，與舊版 string 實作同級。
+*/
+inline std::string canonical_string(const char* p, int len) {
+    std::string best;
+    std::string twice(2 * (size_t)len, '+');
+    for (int v = 0; v < 4; ++v) {
+        bool rev = (v & 1) != 0, neg = (v & 2) != 0;
+        for (int i = 0; i < len; ++i) {
+            bool minus = (p[rev ? len - 1 - i : i] == '-') != neg;
+            twice[i] = twice[i + len] = minus ? '-' : '+';
+        }
+        for (int k = 0; k < len; ++k) {
+            if (best.empty() || std::memcmp(twice.data() + k, best.data(), len) < 0) best.assign(twice, k, len);
+        }
+    }
+    return best;
+}
+
+// L > 64 的 pair key: 兩個 canonical 字串排序後接成 "a,b" (定長 2L+1，字典序 == pair 順序)
+inline std::string canonical_pair_string(const std::string& a, const std::string& b) {
+    return a < b ? a + "," + b : b + "," + a;
+}
+
+#endif
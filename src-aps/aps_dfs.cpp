@@ -4,153 +4,402 @@
 #include <complex>
 #include <algorithm>
 #include <map>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
+#include "aps_gen.h"
+#include "aps_pool.h"
+#include "aps_range_index.h"
+#include "aps_parallel.h"
+#include "aps_sample.h"
 
 using namespace std;
+namespace fs = std::filesystem;
 
 /* =========================
    Global params
    ========================= */
 int L;
-int TARGET_G;
 int ZCZ;
 int PREFIX_CANON;
 int MAX_SEQ;
+int MAX_RHO;                       // <= 0: 不啟用 ACF 剪枝
+int HALF;                          // L / 2
 
-const double PI = acos(-1.0);
+const int PSD_SLACK = ApsGen::PSD_SLACK;
+
+ApsGen::Config make_config(int g) {
+    ApsGen::Config cfg;
+    cfg.L = L;
+    cfg.g = g;
+    cfg.max_rho = MAX_RHO;
+    return cfg;
+}
 
 /* =========================
-   Data structure
-   ========================= */
-struct Seq {
-    vector<int> s;
+   In-Memory Pool (配對模式)
+   =========================
+   [New] 不再是 vector<Seq> (每條兩個 heap vector)，改成三個連續矩陣:
+   seq (M x L, +-1)、psd (M x L/2, k = 1..L/2)、acf (M x L/2, u = 1..L/2)。
+   實數序列 psd(k) = psd(L-k)、rho(u) = rho(L-u)，半邊就夠；
+   ACF 在產生時算一次，配對的完整檢查從 O(L^2) 降為 O(L)。
+*/
+struct FlatPool {
+    size_t size = 0;
+    vector<int8_t> seq;
     vector<int> psd;
+    vector<int> acf;
+
+    const int8_t* s(size_t i) const { return &seq[i * L]; }
+    const int* p(size_t i) const { return &psd[i * max(HALF, 1)]; }
+    const int* r(size_t i) const { return &acf[i * max(HALF, 1)]; }
 };
+FlatPool pool;
 
-/* =========================
-   Canonical (Prefix)
-   ========================= */
-bool prefix_canonical(const vector<int>& s, int len) {
-    for (int sh = 1; sh < len; sh++) {
-        for (int i = 0; i < len; i++) {
-            if (s[i] < s[(i + sh) % len]) goto next_shift; 
-            if (s[i] > s[(i + sh) % len]) return false;    
+void generate_pool(int g) {
+    pool = FlatPool();
+    ApsGen::Generator gen(make_config(g));
+    ApsGen::Generator::State st(gen);
+    gen.run(st, [&](ApsGen::Generator::State& cur) {
+        const vector<int>& s = cur.s;
+        vector<int> psd = gen.leaf_psd(cur);
+        for (int i = 0; i < L; i++) pool.seq.push_back((int8_t)s[i]);
+        for (int k = 1; k <= max(HALF, 1); k++) pool.psd.push_back(k <= HALF ? psd[k] : 0);
+        for (int u = 1; u <= max(HALF, 1); u++) {
+            int r = 0;
+            if (u <= HALF) for (int i = 0; i < L; i++) r += s[i] * s[(i + u) % L];
+            pool.acf.push_back(r);
         }
-        return false; 
-    next_shift:;
-    }
-    return true;
+        pool.size++;
+        if ((int)pool.size >= MAX_SEQ) cur.stop = true;
+    });
 }
 
 /* =========================
-   Correct DFT (Periodic)
-   ========================= */
-vector<int> compute_psd(const vector<int>& s) {
-    vector<int> psd(L);
-    for (int k = 0; k < L; k++) {
-        double real_part = 0;
-        double imag_part = 0;
-        double angle = 2.0 * PI * k / L;
-        
-        for (int n = 0; n < L; n++) {
-            double theta = angle * n;
-            real_part += s[n] * cos(theta);
-            imag_part -= s[n] * sin(theta);
+   Parallel Out-of-Core Pool (driver.sh)
+   =========================
+   1. 單執行緒 DFS 到 split 層，每個存活的前綴 = 一個任務
+   2. Thread pool 以 atomic 計數器搶任務，各自從前綴續跑 DFS
+   3. 葉節點 bit-pack 成 uint64_t 寫入自己的 chunk 檔 (arena 緩衝)，
+      每個任務在 index 記下 (chunk, offset, count)
+   RAM 只放前綴清單，池的大小只受磁碟限制；也不再需要 MAX_SEQ 截斷。
+*/
+bool generate_pool_to_disk(int g, const string& base, int num_threads) {
+    ApsGen::Generator gen(make_config(g));
+    int split = gen.split_depth(num_threads);
+    vector<ApsGen::Prefix> prefixes = gen.split(split);
+
+    vector<ApsPool::TaskEntry> entries(prefixes.size());
+    atomic<size_t> next_task(0);
+    vector<ApsPool::ChunkWriter> writers(num_threads);
+    bool ok = true;
+    for (int t = 0; t < num_threads; t++) ok = writers[t].open(ApsPool::chunk_path(base, t)) && ok;
+    if (!ok) return false;
+
+    auto worker = [&](int tid) {
+        ApsGen::Generator::State st(gen);
+        ApsPool::ChunkWriter& out = writers[tid];
+        auto on_leaf = [&](ApsGen::Generator::State& cur) { out.push(ApsPool::pack(cur.s)); };
+
+        for (size_t t = next_task++; t < prefixes.size(); t = next_task++) {
+            uint64_t begin = out.position();
+            gen.run_prefix(st, prefixes[t], split, on_leaf);
+            entries[t] = { (uint32_t)t, (uint32_t)tid, begin, out.position() - begin };
         }
-        // PSD = |DFT|^2
-        psd[k] = (int)lround(real_part * real_part + imag_part * imag_part);
-    }
-    return psd;
+    };
+
+    vector<thread> pool_threads_list;
+    for (int t = 0; t < num_threads; t++) pool_threads_list.emplace_back(worker, t);
+    for (auto& th : pool_threads_list) th.join();
+
+    // chunk 沒完整寫進磁碟就不寫 index，避免留下指向截斷 chunk 的池
+    for (auto& w : writers) ok = w.close() && ok;
+    if (!ok) return false;
+    return ApsPool::write_index(base, L, g, (uint32_t)num_threads, entries);
 }
 
 /* =========================
-   DFS Generator
-   ========================= */
-vector<Seq> pool;
+   Parallel Text Pool (L > 64)
+   =========================
+   序列放不進一個 uint64_t 時不寫 bit-packed 池，直接平行產生 cand_g<g>.txt:
+   每個前綴任務把葉節點寫進自己的文字緩衝，完成後依任務順序接到檔案
+   (還沒輪到的先暫存)，所以內容與單執行緒 DFS 相同。
+*/
+bool generate_text_to_disk(int g, const string& path, int num_threads, uint64_t& total) {
+    ApsGen::Generator gen(make_config(g));
+    int split = gen.split_depth(num_threads);
+    vector<ApsGen::Prefix> prefixes = gen.split(split);
 
-void dfs(int idx, int ones, vector<int>& s) {
-    if ((int)pool.size() >= MAX_SEQ) return;
+    ofstream out(path);
+    if (!out) return false;
+    vector<string> done(prefixes.size());
+    vector<char> ready(prefixes.size(), 0);
+    size_t next_write = 0;
+    mutex mtx;
+    atomic<size_t> next_task(0);
+    atomic<uint64_t> count(0);
 
-    // Pruning: Hamming weight
-    int rem = L - idx;
-    if (ones > TARGET_G) return;
-    if (ones + rem < TARGET_G) return;
+    auto worker = [&](int) {
+        ApsGen::Generator::State st(gen);
+        for (size_t t = next_task++; t < prefixes.size(); t = next_task++) {
+            string buf;
+            gen.run_prefix(st, prefixes[t], split, [&](ApsGen::Generator::State& cur) {
+                buf += ApsPool::text(cur.s);
+                buf += '\n';
+                count++;
+            });
+            lock_guard<mutex> lk(mtx);
+            done[t].swap(buf);
+            ready[t] = 1;
+            for (; next_write < prefixes.size() && ready[next_write]; next_write++) {
+                out << done[next_write];
+                string().swap(done[next_write]);
+            }
+        }
+    };
 
-    // Pruning: Prefix Canonical (check every 4 steps to save cost)
-    if (idx > 0 && idx % 4 == 0) { 
-        if (!prefix_canonical(s, idx)) return;
-    }
+    vector<thread> pool_threads_list;
+    for (int t = 0; t < num_threads; t++) pool_threads_list.emplace_back(worker, t);
+    for (auto& th : pool_threads_list) th.join();
+    total = count.load();
+    out.close();
+    return (bool)out;
+}
 
-    if (idx == L) {
-        if (!prefix_canonical(s, L)) return; 
-        
-        Seq q;
-        q.s = s;
-        q.psd = compute_psd(s);
-        pool.push_back(q);
-        return;
-    }
+/* =========================
+   Output Mode (driver.sh)
+   =========================
+   ./aps_dfs L g0 g1 max_rho -> results/L/g0_g1/cand_g<g>.{idx,c*.bin} (bit-packed)
+                                + cand_g<g>.txt (每行一條序列，給 aps_match)
+   L > 64 只寫 cand_g<g>.txt (generate_text_to_disk)。
+*/
+int write_candidates(int g0, int g1) {
+    string dir = "results/" + to_string(L) + "/" + to_string(g0) + "_" + to_string(g1);
+    error_code ec;
+    fs::create_directories(dir, ec);
+    int num_threads = aps_thread_count();
 
-    s[idx] = 1;
-    dfs(idx + 1, ones + 1, s);
+    for (int g : {g0, g1}) {
+        string base = dir + "/cand_g" + to_string(g);
+        if (L > ApsPool::MAX_L) {
+            string path = base + ".txt";
+            uint64_t total = 0;
+            if (!generate_text_to_disk(g, path, num_threads, total)) {
+                cerr << "Error: cannot write " << path << "\n";
+                return 1;
+            }
+            cerr << "g=" << g << ": " << total << " candidates (MAX_RHO=" << MAX_RHO << ", threads=" << num_threads
+                 << ", text only) -> " << path << "\n";
+            if (g0 == g1) break;
+            continue;
+        }
+        if (!generate_pool_to_disk(g, base, num_threads)) {
+            cerr << "Error: cannot write " << base << ".*\n";
+            return 1;
+        }
 
-    s[idx] = -1;
-    dfs(idx + 1, ones, s);
+        ApsPool::Reader reader;
+        if (!reader.open(base)) {
+            cerr << "Error: cannot map " << ApsPool::index_path(base) << " (missing, truncated or stale pool)\n";
+            return 1;
+        }
+        string path = base + ".txt";
+        ofstream out(path);
+        if (!out) {
+            cerr << "Error: cannot write " << path << "\n";
+            return 1;
+        }
+        reader.for_each([&](uint64_t w) { out << ApsPool::unpack_string(w, L) << '\n'; });
+
+        cerr << "g=" << g << ": " << reader.header()->total << " candidates (MAX_RHO=" << MAX_RHO
+             << ", threads=" << num_threads << ") -> " << path << "\n";
+        if (g0 == g1) break;
+    }
+    return 0;
 }
 
 /* =========================
-   PACF
-   ========================= */
-int pacf(const vector<int>& s, int u) {
-    int r = 0;
-    for (int i = 0; i < L; i++)
-        r += s[i] * s[(i + u) % L];
-    return r;
+   Sampling Mode (中大型 L)
+   =========================
+   ./aps_dfs L g0 g1 max_rho sample <draws> [seed] [mix]
+   每個 g 抽 draws 次 (每 SAMPLE_TILE 次一個 tile，種子由 (seed, g, tile) 決定，
+   結果與 thread 數無關)，收下的 canonical 序列去重後寫成 cand_g<g>.txt。
+   mix = 0 (預設) 每次獨立均勻抽樣；mix > 0 改用換位 walk (較快但樣本相關、只近似均勻)，見 aps_sample.h。
+   L <= 64 時另外寫 bit-packed 池 (單一任務)，格式與窮舉模式相同。
+*/
+const long long SAMPLE_TILE = 4096;
+
+int write_candidates_sampled(int g0, int g1, long long draws, uint64_t seed, int mix) {
+    string dir = "results/" + to_string(L) + "/" + to_string(g0) + "_" + to_string(g1);
+    error_code ec;
+    fs::create_directories(dir, ec);
+    int num_threads = aps_thread_count();
+
+    for (int g : {g0, g1}) {
+        size_t num_tiles = (size_t)((draws + SAMPLE_TILE - 1) / SAMPLE_TILE);
+        vector<vector<string>> tile_out(num_tiles);
+        vector<ApsSample::Stats> tile_stats(num_tiles);
+
+        parallel_tiles(num_tiles, num_threads, [&](size_t t, int) {
+            uint64_t tile_seed = seed * 0x9E3779B97F4A7C15ULL + (uint64_t)g * 1000003ULL + t;
+            ApsSample::Sampler sampler(L, g, MAX_RHO, tile_seed);
+            long long n = min<long long>(SAMPLE_TILE, draws - (long long)t * SAMPLE_TILE);
+            string seq;
+            for (long long d = 0; d < n; d++) {
+                if (sampler.draw(mix, seq, tile_stats[t])) tile_out[t].push_back(seq);
+            }
+        });
+
+        ApsSample::Stats total;
+        vector<string> pool_out;
+        for (size_t t = 0; t < num_tiles; t++) {
+            total.drawn += tile_stats[t].drawn;
+            total.accepted += tile_stats[t].accepted;
+            total.spectral_reject += tile_stats[t].spectral_reject;
+            total.acf_reject += tile_stats[t].acf_reject;
+            total.periodic_reject += tile_stats[t].periodic_reject;
+            pool_out.insert(pool_out.end(), tile_out[t].begin(), tile_out[t].end());
+            vector<string>().swap(tile_out[t]);
+        }
+        sort(pool_out.begin(), pool_out.end());
+        pool_out.erase(unique(pool_out.begin(), pool_out.end()), pool_out.end());
+
+        string base = dir + "/cand_g" + to_string(g);
+        string path = base + ".txt";
+        ofstream out(path);
+        if (!out) {
+            cerr << "Error: cannot write " << path << "\n";
+            return 1;
+        }
+        for (const auto& q : pool_out) out << q << '\n';
+
+        if (L <= ApsPool::MAX_L) {
+            ApsPool::ChunkWriter w;
+            if (!w.open(ApsPool::chunk_path(base, 0))) {
+                cerr << "Error: cannot write " << base << ".*\n";
+                return 1;
+            }
+            vector<int> v(L);
+            for (const auto& q : pool_out) {
+                for (int i = 0; i < L; i++) v[i] = (q[i] == '+') ? 1 : -1;
+                w.push(ApsPool::pack(v));
+            }
+            uint64_t count = w.position();
+            vector<ApsPool::TaskEntry> entries(1, ApsPool::TaskEntry{ 0, 0, 0, count });
+            if (!w.close() || !ApsPool::write_index(base, L, g, 1, entries)) {
+                cerr << "Error: cannot write " << base << ".*\n";
+                return 1;
+            }
+        }
+
+        double rate = total.drawn ? 100.0 * total.accepted / total.drawn : 0.0;
+        cerr << "g=" << g << ": sampled " << total.drawn << " ("
+             << (mix > 0 ? "walk mix=" + to_string(mix) + ", correlated" : string("independent uniform"))
+             << ", seed=" << seed << ")"
+             << " | accepted " << total.accepted << " (" << rate << "%)"
+             << " | rejected: spectral " << total.spectral_reject << ", acf " << total.acf_reject
+             << ", periodic " << total.periodic_reject << "\n";
+        cerr << "g=" << g << ": " << pool_out.size() << " unique candidates (MAX_RHO=" << MAX_RHO
+             << ", threads=" << num_threads << ") -> " << path << "\n";
+        if (g0 == g1) break;
+    }
+    return 0;
 }
 
 /* =========================
    Main
    ========================= */
 int main(int argc, char** argv) {
+    if (argc >= 7 && string(argv[5]) == "sample") {
+        L = atoi(argv[1]);
+        HALF = L / 2;
+        MAX_RHO = atoi(argv[4]);
+        long long draws = atoll(argv[6]);
+        uint64_t seed = (argc >= 8) ? strtoull(argv[7], nullptr, 10) : 1;
+        int mix = (argc >= 9) ? atoi(argv[8]) : 0;
+        return write_candidates_sampled(atoi(argv[2]), atoi(argv[3]), draws, seed, max(mix, 0));
+    }
+
+    if (argc == 5) {
+        L = atoi(argv[1]);
+        HALF = L / 2;
+        MAX_RHO = atoi(argv[4]);
+        ZCZ = 0;
+        PREFIX_CANON = 1;
+        return write_candidates(atoi(argv[2]), atoi(argv[3]));
+    }
+
     if (argc < 6) {
-        cerr << "Usage: L g Z prefix max_seq\n";
+        cerr << "Usage: L g Z prefix max_seq [max_rho]\n";
+        cerr << "       L g0 g1 max_rho   (output mode: results/L/g0_g1/cand_g*.txt)\n";
+        cerr << "       L g0 g1 max_rho sample draws [seed] [mix]   (sampling mode, L 60~100)\n";
+        cerr << "         mix = 0: independent uniform draws (default); mix > 0: swap walk, correlated and only\n";
+        cerr << "         approximately uniform\n";
         return 1;
     }
 
     L = atoi(argv[1]);
-    TARGET_G = atoi(argv[2]);
+    HALF = L / 2;
     ZCZ = atoi(argv[3]);
     PREFIX_CANON = atoi(argv[4]);
     MAX_SEQ = atoi(argv[5]);
+    MAX_RHO = (argc >= 7) ? atoi(argv[6]) : 0;
 
     bool is_even = (L % 2 == 0);
 
-    vector<int> s(L);
-    dfs(0, 0, s);
+    generate_pool(atoi(argv[2]));
+
+    cerr << "Generated " << pool.size << " sequences. Starting PSD pairing...\n";
 
-    cerr << "Generated " << pool.size() << " sequences. Starting PSD pairing...\n";
+    // [New] Spectral band join: PSD filter 是盒子查詢
+    //   2L - slack - psd_i[k] <= psd_j[k] <= 2L + slack - psd_i[k]
+    // 池依鑑別力最高的幾個 PSD 座標建 RangeIndex，每個 i 只走進互補頻帶內的 j，
+    // 其餘座標 (k = 1..L/2，另一半共軛對稱) 與 ACF 再做完整檢查；成本接近輸出敏感
+    int dims = max(HALF, 1);
+    RangeIndex<int> psd_index;
+    psd_index.build(pool.psd.data(), pool.size, dims, HALF);
+
+    vector<int> lo(dims), hi(dims);
+    vector<uint32_t> cand;
+    for (size_t i = 0; i < pool.size; i++) {
+        const int* pi = pool.p(i);
+        for (int k = 0; k < HALF; k++) {
+            lo[k] = 2 * L - PSD_SLACK - pi[k];
+            hi[k] = 2 * L + PSD_SLACK - pi[k];
+        }
+        cand.clear();
+        psd_index.query(lo.data(), hi.data(), [&](uint32_t j) {
+            if (j >= i) cand.push_back(j);   // j starts from i to match symmetric pairs
+        });
+        sort(cand.begin(), cand.end());
+
+        for (size_t j : cand) {
 
-    // O(M^2) with PSD filter
-    for (size_t i = 0; i < pool.size(); i++) {
-        for (size_t j = i; j < pool.size(); j++) { // j starts from i to match symmetric pairs
-            
             // --- Layer 1: Frequency Domain (PSD) Filter ---
+            const int* pj = pool.p(j);
             bool psd_pass = true;
-            for(int k=1; k<L; k++) { 
-                int v = pool[i].psd[k] + pool[j].psd[k];
+            for (int k = 0; k < HALF; k++) {
                 // Relaxed constraint for Optimal PACP search
-                if (abs(v - 2*L) > 10) { 
-                    psd_pass = false; 
-                    break; 
+                if (abs(pi[k] + pj[k] - 2 * L) > PSD_SLACK) {
+                    psd_pass = false;
+                    break;
                 }
             }
-            if(!psd_pass) continue;
+            if (!psd_pass) continue;
 
             // --- Layer 2: Time Domain (PACF) Check ---
+            // rho(u) = rho(L-u)，u = 1..L/2 已涵蓋所有 lag (ZCZ 條件對 u 與 L-u 相同)
+            const int* ri = pool.r(i);
+            const int* rj = pool.r(j);
             bool ok = true;
 
-            for (int u = 1; u < L; u++) {
-                int sum_rho = pacf(pool[i].s, u) + pacf(pool[j].s, u);
-                
+            for (int u = 1; u <= HALF; u++) {
+                int sum_rho = ri[u - 1] + rj[u - 1];
+
                 // ZCZ Check
                 if (u < ZCZ && sum_rho != 0) {
                     ok = false;
@@ -175,9 +424,9 @@ int main(int argc, char** argv) {
 
             if (ok) {
                 cout << "FOUND: ";
-                for (int x : pool[i].s) cout << (x == 1 ? '+' : '-');
+                for (int x = 0; x < L; x++) cout << (pool.s(i)[x] == 1 ? '+' : '-');
                 cout << " ";
-                for (int x : pool[j].s) cout << (x == 1 ? '+' : '-');
+                for (int x = 0; x < L; x++) cout << (pool.s(j)[x] == 1 ? '+' : '-');
                 cout << endl;
             }
         }
@@ -2,85 +2,263 @@
 #include <vector>
 #include <string>
 #include <fstream>
-#include <set>
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <queue>
+#include "../lib/pacp_mmap.h"
+#include "aps_parallel.h"
+#include "aps_canon.h"
 
 using namespace std;
 using namespace std::chrono;
 
-// Generate the canonical (lexicographical smallest) form of a sequence
-// Handles: Cyclic Shift, Reversal, and Negation
-string get_canonical(string s) {
-    int L = s.length();
-    string canonical = s;
-    for (int n = 0; n < 2; ++n) { // Negation
-        for (int r = 0; r < 2; ++r) { // Reversal
-            string temp = s;
-            for (int k = 0; k < L; ++k) { // All cyclic shifts
-                if (temp < canonical) canonical = temp;
-                rotate(temp.begin(), temp.begin() + 1, temp.end());
-            }
-            reverse(s.begin(), s.end());
+/* =========================
+   Key Codecs
+   =========================
+   L <= 64: PairKey (兩個 packed canonical，16 bytes)，fast path
+   L >  64: 定長字串 "a,b" (canonical_string，2L+1 bytes)，排序後直接就是輸出行
+   兩者的排序都 == 舊版 set<pair<string,string>> 的順序；run 檔都是定長紀錄。
+*/
+struct PackedCodec {
+    typedef PairKey Key;
+    int L;
+    size_t rec_size() const { return sizeof(PairKey); }
+    bool make(const char* a, const char* b, Key& k) const {
+        uint64_t wa, wb;
+        if (!pack_seq(a, L, wa) || !pack_seq(b, L, wb)) return false;
+        k = canonical_pair(get_canonical(wa, L), get_canonical(wb, L));
+        return true;
+    }
+    void store(const Key& k, char* dst) const {
+        memcpy(dst, &k.first, sizeof(uint64_t));
+        memcpy(dst + sizeof(uint64_t), &k.second, sizeof(uint64_t));
+    }
+    void load(const char* src, Key& k) const {
+        memcpy(&k.first, src, sizeof(uint64_t));
+        memcpy(&k.second, src + sizeof(uint64_t), sizeof(uint64_t));
+    }
+    void line(const Key& k, string& out) const {
+        out = unpack_seq(k.first, L);
+        out += ',';
+        out += unpack_seq(k.second, L);
+    }
+};
+
+struct TextCodec {
+    typedef string Key;
+    int L;
+    size_t rec_size() const { return 2 * (size_t)L + 1; }
+    bool make(const char* a, const char* b, Key& k) const {
+        k = canonical_pair_string(canonical_string(a, L), canonical_string(b, L));
+        return true;
+    }
+    void store(const Key& k, char* dst) const { memcpy(dst, k.data(), rec_size()); }
+    void load(const char* src, Key& k) const { k.assign(src, rec_size()); }
+    void line(const Key& k, string& out) const { out = k; }
+};
+
+/* =========================
+   External Sort (Spill + K-Way Merge)
+   =========================
+   記憶體中的 key 超過 mem_limit 就排序去重後寫成一個 run 檔；
+   最後以 priority_queue 做 k-way merge，合併時順便去重。
+*/
+template <typename Codec>
+struct RunReader {
+    FILE* f = nullptr;
+    vector<char> buf;
+    size_t pos = 0, len = 0;
+
+    bool refill(const Codec& codec) {
+        len = f ? fread(buf.data(), codec.rec_size(), buf.size() / codec.rec_size(), f) : 0;
+        pos = 0;
+        return len > 0;
+    }
+    bool next(const Codec& codec, typename Codec::Key& k) {
+        if (pos == len && !refill(codec)) return false;
+        codec.load(buf.data() + (pos++) * codec.rec_size(), k);
+        return true;
+    }
+};
+
+template <typename Codec>
+bool spill_run(const Codec& codec, vector<typename Codec::Key>& keys, const string& path) {
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    vector<char> rec(codec.rec_size() * 4096);
+    size_t n = 0;
+    bool ok = true;
+    for (const auto& k : keys) {
+        codec.store(k, rec.data() + n * codec.rec_size());
+        if (++n == 4096) {
+            ok = fwrite(rec.data(), codec.rec_size(), n, f) == n && ok;
+            n = 0;
         }
-        for (char &c : s) c = (c == '+') ? '-' : '+';
     }
-    return canonical;
+    if (n) ok = fwrite(rec.data(), codec.rec_size(), n, f) == n && ok;
+    ok = (fclose(f) == 0) && ok;
+    vector<typename Codec::Key>().swap(keys);
+    return ok;
 }
 
-int main(int argc, char* argv[]) {
-    // Standard input pattern: L g0 g1
-    if (argc < 4) {
-        cout << "Usage: ./aps_filter <L> <g0> <g1>" << endl;
-        return 1;
-    }
+// run 檔的路徑: 不論正常結束或中途出錯，離開 run_filter 時都刪掉
+struct RunFiles {
+    vector<string> paths;
+    ~RunFiles() { for (const auto& r : paths) remove(r.c_str()); }
+    size_t size() const { return paths.size(); }
+    bool empty() const { return paths.empty(); }
+};
 
-    int L = atoi(argv[1]);
-    int g0 = atoi(argv[2]);
-    int g1 = atoi(argv[3]);
+// 依序把所有不重複的 key 交給 emit
+template <typename Codec, typename Emit>
+void merge_runs(const Codec& codec, const vector<string>& runs, Emit&& emit) {
+    typedef typename Codec::Key Key;
+    const size_t BUF_KEYS = 1 << 14;
+    vector<RunReader<Codec>> readers(runs.size());
+    typedef pair<Key, size_t> Item;
+    priority_queue<Item, vector<Item>, greater<Item>> heap;
 
-    string dir = "results/" + to_string(L) + "/" + to_string(g0) + "_" + to_string(g1);
-    string in_path = dir + "/match_result.txt";
-    string out_path = dir + "/unique_result.txt";
+    for (size_t r = 0; r < runs.size(); ++r) {
+        readers[r].f = fopen(runs[r].c_str(), "rb");
+        readers[r].buf.resize(BUF_KEYS * codec.rec_size());
+        Key k;
+        if (readers[r].next(codec, k)) heap.push({k, r});
+    }
 
-    ifstream fin(in_path);
-    if (!fin) {
-        cerr << "Error: Cannot find match_result.txt in " << dir << endl;
-        return 1;
+    bool has_last = false;
+    Key last;
+    while (!heap.empty()) {
+        Item top = heap.top();
+        heap.pop();
+        if (!has_last || top.first != last) {
+            emit(top.first);
+            last = top.first;
+            has_last = true;
+        }
+        Key k;
+        if (readers[top.second].next(codec, k)) heap.push({k, top.second});
     }
+    for (auto& r : readers) if (r.f) fclose(r.f);
+}
+
+// 解析 + 去重 + 輸出；Codec 決定 key 的表示 (packed / text)
+template <typename Codec>
+int run_filter(const Codec& codec, int L, int g0, int g1, const string& dir, const MappedFile& fin,
+               size_t mem_limit) {
+    typedef typename Codec::Key Key;
+    string out_path = dir + "/unique_result.txt";
 
     cout << "-------------------------------------------" << endl;
     cout << " APS Filter | Stage 4 | L=" << L << " | Weight: " << g0 << "," << g1 << endl;
     cout << " Filtering equivalence classes..." << endl;
 
     auto start_time = high_resolution_clock::now();
-    
-    // Use set of pairs to store mathematically unique PACP pairs
-    set<pair<string, string>> unique_pairs;
-    string line;
-    int raw_count = 0;
 
-    while (getline(fin, line)) {
-        if (line.empty()) continue;
-        raw_count++;
-        
-        size_t comma = line.find(',');
-        if (comma == string::npos) continue;
+    // 檔案切成約 CHUNK_BYTES 的段落 (切點對齊換行)，每段一個 tile
+    const size_t CHUNK_BYTES = (size_t)4 << 20;
+    const char* data = fin.data();
+    size_t size = fin.size();
+    vector<size_t> cuts(1, 0);
+    while (cuts.back() < size) {
+        size_t c = min(size, cuts.back() + CHUNK_BYTES);
+        while (c < size && data[c - 1] != '\n') ++c;
+        cuts.push_back(c);
+    }
+    size_t num_chunks = cuts.size() - 1;
+
+    atomic<long long> raw_count(0);
+    atomic<bool> bad_length(false);
+    int num_threads = aps_thread_count();
+    size_t batch_tiles = (size_t)num_threads * 4;
 
-        string a = get_canonical(line.substr(0, comma));
-        string b = get_canonical(line.substr(comma + 1));
+    vector<Key> pending;
+    RunFiles runs;
 
-        // Sort pair to handle {A, B} == {B, A}
-        if (a < b) unique_pairs.insert({a, b});
-        else unique_pairs.insert({b, a});
+    for (size_t b0 = 0; b0 < num_chunks; b0 += batch_tiles) {
+        size_t nb = min(batch_tiles, num_chunks - b0);
+        vector<vector<Key>> out(nb);
+
+        parallel_tiles(nb, num_threads, [&](size_t t, int) {
+            const char* p = data + cuts[b0 + t];
+            const char* end = data + cuts[b0 + t + 1];
+            vector<Key>& keys = out[t];
+            long long lines = 0;
+            while (p < end) {
+                const char* nl = (const char*)memchr(p, '\n', end - p);
+                const char* e = nl ? nl : end;
+                const char* line_end = e;
+                if (line_end > p && line_end[-1] == '\r') --line_end;
+                if (line_end > p) {
+                    lines++;
+                    const char* comma = (const char*)memchr(p, ',', line_end - p);
+                    if (comma) {
+                        int la = (int)(comma - p), lb = (int)(line_end - comma - 1);
+                        Key k;
+                        if (la == L && lb == L && codec.make(p, comma + 1, k)) {
+                            keys.push_back(std::move(k));
+                        } else {
+                            bad_length = true;
+                        }
+                    }
+                }
+                p = e + 1;
+            }
+            sort(keys.begin(), keys.end());
+            keys.erase(unique(keys.begin(), keys.end()), keys.end());
+            raw_count += lines;
+        });
+
+        for (auto& k : out) {
+            pending.insert(pending.end(), k.begin(), k.end());
+            vector<Key>().swap(k);
+        }
+        if (pending.size() > mem_limit) {
+            sort(pending.begin(), pending.end());
+            pending.erase(unique(pending.begin(), pending.end()), pending.end());
+            if (pending.size() > mem_limit / 2) {
+                string run = dir + "/filter_run_" + to_string(runs.size()) + ".bin";
+                runs.paths.push_back(run);
+                if (!spill_run(codec, pending, run)) {
+                    cerr << "Error: cannot write " << run << endl;
+                    return 1;
+                }
+            }
+        }
+        cout << "\r Parsed " << raw_count.load() << " raw pairs | Runs: " << runs.size() << flush;
     }
-    fin.close();
+    cout << endl;
+    if (bad_length) cerr << "[Warning] Skipped lines whose sequences are not of length " << L << endl;
 
-    // Output results
+    // Output results (依 key 排序 == 舊版 set<pair<string,string>> 的順序)
     ofstream fout(out_path);
-    for (const auto& p : unique_pairs) {
-        fout << p.first << "," << p.second << "\n";
+    size_t unique_count = 0;
+    string text;
+    auto emit = [&](const Key& k) {
+        codec.line(k, text);
+        fout << text << "\n";
+        unique_count++;
+    };
+    if (runs.empty()) {
+        sort(pending.begin(), pending.end());
+        pending.erase(unique(pending.begin(), pending.end()), pending.end());
+        for (const auto& k : pending) emit(k);
+    } else {
+        if (!pending.empty()) {
+            string run = dir + "/filter_run_" + to_string(runs.size()) + ".bin";
+            runs.paths.push_back(run);
+            if (!spill_run(codec, pending, run)) {
+                cerr << "Error: cannot write " << run << endl;
+                return 1;
+            }
+        }
+        merge_runs(codec, runs.paths, emit);
     }
     fout.close();
 
@@ -89,11 +267,46 @@ int main(int argc, char* argv[]) {
 
     cout << "-------------------------------------------" << endl;
     cout << " Filter Report:" << endl;
-    cout << " - Raw pairs processed: " << raw_count << endl;
-    cout << " - Unique classes found: " << unique_pairs.size() << endl;
+    cout << " - Raw pairs processed: " << raw_count.load() << endl;
+    cout << " - Unique classes found: " << unique_count << endl;
+    cout << " - Spilled runs: " << runs.size() << endl;
     cout << " - Time elapsed: " << duration.count() / 1000.0 << " s" << endl;
     cout << " - Saved to: " << out_path << endl;
     cout << "-------------------------------------------" << endl;
 
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    // Standard input pattern: L g0 g1
+    if (argc < 4) {
+        cout << "Usage: ./aps_filter <L> <g0> <g1>" << endl;
+        return 1;
+    }
+
+    int L = atoi(argv[1]);
+    int g0 = atoi(argv[2]);
+    int g1 = atoi(argv[3]);
+
+    string dir = "results/" + to_string(L) + "/" + to_string(g0) + "_" + to_string(g1);
+    string in_path = dir + "/match_result.txt";
+
+    MappedFile fin;
+    if (!fin.open(in_path)) {
+        cerr << "Error: Cannot find match_result.txt in " << dir << endl;
+        return 1;
+    }
+    if (L <= 0) {
+        cerr << "Error: L must be positive" << endl;
+        return 1;
+    }
+
+    // 記憶體中最多保留的 key 數 (以 16-byte 的 PairKey 計)，超過就 spill；可用 APS_FILTER_MEM 覆寫
+    // L > 64 的字串 key 較大，依紀錄長度等比例縮小，記憶體上限不變
+    const char* mem_env = getenv("APS_FILTER_MEM");
+    size_t mem_limit = mem_env ? (size_t)atoll(mem_env) : ((size_t)1 << 24);
+
+    if (L <= 64) return run_filter(PackedCodec{ L }, L, g0, g1, dir, fin, max<size_t>(mem_limit, 1));
+    TextCodec codec{ L };
+    return run_filter(codec, L, g0, g1, dir, fin, max<size_t>(mem_limit * sizeof(PairKey) / (codec.rec_size() + 32), 1));
+}
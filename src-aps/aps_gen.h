@@ -0,0 +1,261 @@
+// ==========================================
+// Filename: aps_gen.h
+// Optimization: Reusable Pruned DFS Generator (Incremental DFT + Partial ACF)
+// ==========================================
+//
+// aps_dfs 的 DFS 產生器抽成可重入的類別: 設定 (L, g, MAX_RHO) 各自一份唯讀表，
+// 搜尋狀態 (部分 DFT / ACF) 每個 thread 一份，所以同一個程序可以同時產生
+// 不同權重的候選池 (aps_sched)，或把葉節點直接串流給下一階段 (aps_stream)。
+
+#ifndef APS_GEN_H
+#define APS_GEN_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+namespace ApsGen {
+
+    const double PI = std::acos(-1.0);
+    const int PSD_SLACK = 10;      // 與配對階段 |psd_i + psd_j - 2L| <= 10 一致
+
+    struct Config {
+        int L = 0;
+        int g = 0;                 // +1 的個數
+        int max_rho = 0;           // <= 0: 不啟用 ACF 剪枝
+        int psd_slack = PSD_SLACK;
+    };
+
+    /* =========================
+       Canonical (Prefix)
+       ========================= */
+    inline bool prefix_canonical(const std::vector<int>& s, int len) {
+        for (int sh = 1; sh < len; sh++) {
+            for (int i = 0; i < len; i++) {
+                if (s[i] < s[(i + sh) % len]) goto next_shift;
+                if (s[i] > s[(i + sh) % len]) return false;
+            }
+            return false;
+        next_shift:;
+        }
+        return true;
+    }
+
+    struct Prefix {
+        uint64_t bits;
+        int ones;
+    };
+
+    class Generator {
+    public:
+        /* =========================
+           Incremental DFT (Periodic)
+           =========================
+           F_k = sum_n s[n] * W^(k*n)，W = exp(-2*pi*i/L)
+           DFS 每放一個 s[idx] 就對每個 k 加一項 (查 twiddle 表)，葉節點不再重算 DFT。
+           實數序列 F_{L-k} = conj(F_k)，只需維護 k = 0..L/2。
+
+           Partial Periodic ACF (MAX_RHO)
+           rho(u) = sum_i s[i] * s[(i+u)%L]。DFS 放好前 d 個元素時，兩端都 < d 的項已固定，
+           其餘 free[d][u] 項每項 +-1，所以 |rho(u)| >= |fixed| - free。
+           |fixed| - free > MAX_RHO 即可剪掉整棵子樹。
+           rho(u) = rho(L-u) 且兩者的項一一對應，只需 u = 1..L/2。
+        */
+        struct State {
+            std::vector<int> s;
+            std::vector<double> re, im;    // 第 d 層 (已放 d 個元素) 的 DFT 部分和: [d * (H+1) + k]
+            std::vector<int> acf;          // 第 d 層的 ACF 部分和: [d * (H+1) + u]
+            bool stop = false;
+
+            explicit State(const Generator& gen)
+                : s(gen.L), re((gen.L + 1) * (gen.H + 1), 0.0), im((gen.L + 1) * (gen.H + 1), 0.0),
+                  acf((gen.L + 1) * (gen.H + 1), 0) {}
+        };
+
+        explicit Generator(const Config& c) : cfg(c), L(c.L), H(c.L / 2) {
+            tw_cos.resize(L);
+            tw_sin.resize(L);
+            for (int m = 0; m < L; m++) {
+                tw_cos[m] = std::cos(2.0 * PI * m / L);
+                tw_sin[m] = -std::sin(2.0 * PI * m / L);
+            }
+
+            // 配對時 psd_i[k] + psd_j[k] <= 2L + slack 且 psd_j >= 0，所以單條序列 |F_k|^2 <= 2L + slack。
+            // 剩下 rem 項每項模長 1: |F_k| >= |partial| - rem，故 |partial| > sqrt(2L+slack) + rem 必然出局
+            // (psd 會 lround 成整數，所以界限放寬 0.5)
+            double r = std::sqrt(2.0 * L + cfg.psd_slack + 0.5);
+            psd_bound2.resize(L + 1);
+            for (int rem = 0; rem <= L; rem++) psd_bound2[rem] = (r + rem) * (r + rem);
+
+            acf_free.assign((L + 1) * (H + 1), 0);
+            for (int d = 0; d <= L; d++) {
+                for (int u = 1; u <= H; u++) {
+                    int fixed = 0;
+                    for (int i = 0; i < d; i++) if ((i + u) % L < d) fixed++;
+                    acf_free[d * (H + 1) + u] = L - fixed;
+                }
+            }
+        }
+
+        const Config cfg;
+        const int L, H;
+
+        // 葉節點的 PSD (四捨五入成整數，k = 0..L-1)
+        std::vector<int> leaf_psd(const State& st) const {
+            const double* re = &st.re[L * (H + 1)];
+            const double* im = &st.im[L * (H + 1)];
+            std::vector<int> psd(L);
+            for (int k = 0; k <= H; k++) {
+                psd[k] = (int)std::lround(re[k] * re[k] + im[k] * im[k]);
+                if (k > 0) psd[L - k] = psd[k];
+            }
+            return psd;
+        }
+
+        // 完整 DFS: on_leaf(State&) 收到每個通過的序列 (可設 st.stop 提早結束)
+        template <typename Leaf>
+        void run(State& st, Leaf&& on_leaf) const {
+            dfs(st, 0, 0, -1, on_leaf, [](State&, int) {});
+        }
+
+        // DFS 到 depth 層為止，回傳所有存活的前綴 (平行化的任務單位)
+        std::vector<Prefix> split(int depth) const {
+            std::vector<Prefix> out;
+            State st(*this);
+            dfs(st, 0, 0, depth, [](State&) {}, [&](State& cur, int ones) {
+                uint64_t bits = 0;
+                for (int i = 0; i < depth; i++) if (cur.s[i] < 0) bits |= (1ULL << i);
+                out.push_back({ bits, ones });
+            });
+            return out;
+        }
+
+        // 從前綴續跑 DFS (重放前綴以重建第 0..depth 層的部分和)
+        template <typename Leaf>
+        void run_prefix(State& st, const Prefix& p, int depth, Leaf&& on_leaf) const {
+            for (int i = 0; i < depth; i++) {
+                st.s[i] = ((p.bits >> i) & 1ULL) ? -1 : 1;
+                push_level(st, i);
+            }
+            dfs(st, depth, p.ones, -1, on_leaf, [](State&, int) {});
+        }
+
+        // 前綴層數: 任務數約為 thread 數的幾十倍，負載才平均
+        int split_depth(int num_threads) const {
+            int split = (L > 8) ? 4 : 0;
+            while (split < L - 8 && (1LL << split) < 64LL * num_threads) split++;
+            return split;
+        }
+
+        // 第 idx 層 -> 第 idx+1 層 (s[idx] 已設定好)
+        void push_level(State& st, int idx) const {
+            dft_push(st, idx, st.s[idx]);
+            if (cfg.max_rho > 0) acf_push(st, idx);
+        }
+
+    private:
+        std::vector<double> tw_cos, tw_sin;    // W^m, m = 0..L-1
+        std::vector<double> psd_bound2;        // psd_bound2[rem] = (sqrt(2L + slack) + rem)^2
+        std::vector<int> acf_free;             // [d * (H+1) + u]，只與深度有關
+
+        // 加上 s[idx] * W^(k*idx)
+        void dft_push(State& st, int idx, int v) const {
+            const double* re0 = &st.re[idx * (H + 1)];
+            const double* im0 = &st.im[idx * (H + 1)];
+            double* re1 = &st.re[(idx + 1) * (H + 1)];
+            double* im1 = &st.im[(idx + 1) * (H + 1)];
+            int m = 0;
+            for (int k = 0; k <= H; k++) {
+                re1[k] = re0[k] + v * tw_cos[m];
+                im1[k] = im0[k] + v * tw_sin[m];
+                m += idx;
+                if (m >= L) m -= L;
+            }
+        }
+
+        // 第 idx 層的任一頻率 (k >= 1) 已經不可能回到 2L + slack 以內
+        bool spectrum_exceeded(const State& st, int idx) const {
+            const double* re = &st.re[idx * (H + 1)];
+            const double* im = &st.im[idx * (H + 1)];
+            double bound2 = psd_bound2[L - idx];
+            for (int k = 1; k <= H; k++) {
+                if (re[k] * re[k] + im[k] * im[k] > bound2) return true;
+            }
+            return false;
+        }
+
+        // 加入 s[idx] 與已放元素形成的項 (i = idx 或 (i+u)%L = idx)
+        void acf_push(State& st, int idx) const {
+            const int* a0 = &st.acf[idx * (H + 1)];
+            int* a1 = &st.acf[(idx + 1) * (H + 1)];
+            const std::vector<int>& s = st.s;
+            int v = s[idx];
+            for (int u = 1; u <= H; u++) {
+                int acc = a0[u];
+                int j = idx + u - L;           // i = idx, (idx+u)%L 已放 (必須繞回)
+                if (j >= 0) acc += v * s[j];
+                int i = idx - u;               // (i+u)%L = idx，i 已放
+                if (i >= 0) acc += s[i] * v;
+                a1[u] = acc;
+            }
+        }
+
+        bool acf_exceeded(const State& st, int idx) const {
+            const int* a = &st.acf[idx * (H + 1)];
+            const int* f = &acf_free[idx * (H + 1)];
+            for (int u = 1; u <= H; u++) {
+                if (std::abs(a[u]) - f[u] > cfg.max_rho) return true;
+            }
+            return false;
+        }
+
+        /* =========================
+           DFS Generator
+           ========================= */
+        template <typename Leaf, typename OnPrefix>
+        void dfs(State& st, int idx, int ones, int split_depth, Leaf&& on_leaf, OnPrefix&& on_prefix) const {
+            if (st.stop) return;
+
+            // Pruning: Hamming weight
+            int rem = L - idx;
+            if (ones > cfg.g) return;
+            if (ones + rem < cfg.g) return;
+
+            std::vector<int>& s = st.s;
+
+            // Pruning: Prefix Canonical (check every 4 steps to save cost)
+            if (idx > 0 && idx % 4 == 0) {
+                if (!prefix_canonical(s, idx)) return;
+            }
+
+            // Pruning: 部分頻譜已超出 2L + slack
+            if (idx > 0 && spectrum_exceeded(st, idx)) return;
+
+            // Pruning: 部分週期 ACF 已超出 MAX_RHO
+            if (cfg.max_rho > 0 && idx > 0 && acf_exceeded(st, idx)) return;
+
+            if (idx == L) {
+                if (!prefix_canonical(s, L)) return;
+                on_leaf(st);
+                return;
+            }
+
+            if (idx == split_depth) {
+                on_prefix(st, ones);
+                return;
+            }
+
+            s[idx] = 1;
+            push_level(st, idx);
+            dfs(st, idx + 1, ones + 1, split_depth, on_leaf, on_prefix);
+
+            s[idx] = -1;
+            push_level(st, idx);
+            dfs(st, idx + 1, ones, split_depth, on_leaf, on_prefix);
+        }
+    };
+}
+
+#endif
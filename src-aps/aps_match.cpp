@@ -6,25 +6,47 @@
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "aps_match_core.h"
 
 using namespace std;
 using namespace std::chrono;
 
-// Periodic Autocorrelation Function (PACF)
-int calc_pacf(const string& s, int u, int L) {
-    int sum = 0;
-    for (int i = 0; i < L; ++i) {
-        sum += ((s[i] == '+') ? 1 : -1) * ((s[(i + u) % L] == '+') ? 1 : -1);
-    }
-    return sum;
+// 交叉配對 (RangeIndex 盒子查詢 + 完整檢查)
+template <typename T>
+PairList run_match(const vector<string>& poolA, const vector<string>& poolB, bool same_pool,
+                   int L, int target_sum, MatchStats& stats) {
+    AcfMatrix<T> accA, accB;
+    accA.build(poolA, L);
+    if (!same_pool) accB.build(poolB, L);
+    CrossMatcher<T> m(accA, same_pool ? accA : accB, same_pool, L, target_sum);
+    return run_tiles(m, poolA.size(), "Checked", stats);
+}
+
+// 補值雜湊連接 (只輸出 Goal 1 / Goal 2 的精確解)
+template <typename T>
+PairList run_join(const vector<string>& poolA, const vector<string>& poolB, bool same_pool,
+                  int L, int target_sum, MatchStats& stats) {
+    AcfMatrix<T> accA, accB;
+    accA.build(poolA, L);
+    if (!same_pool) accB.build(poolB, L);
+    JoinMatcher<T> m(accA, same_pool ? accA : accB, same_pool, L, target_sum);
+    return run_tiles(m, poolA.size(), "Probes", stats);
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 4) return 1;
+    if (argc < 4) {
+        cerr << "Usage: L g0 g1 [cross|join]\n";
+        return 1;
+    }
 
     int L = atoi(argv[1]);
     int g0 = atoi(argv[2]);
     int g1 = atoi(argv[3]);
+    // cross: 全配對 (偶數 L 接受每個 lag |sum| <= 4)
+    // join : 補值雜湊連接，只輸出 Goal 1 (奇數) / Goal 2 (偶數) 的精確解
+    bool join = (argc >= 5 && string(argv[4]) == "join");
 
     // PDF Parity Logic: Odd L (Goal 1) = 2, Even L (Goal 2) = 4
     int target_sum = (L % 2 != 0) ? 2 : 4;
@@ -43,43 +65,45 @@ int main(int argc, char* argv[]) {
     while (getline(fB, line)) if (!line.empty()) poolB.push_back(line);
     fA.close(); fB.close();
 
-    cout << "--- Matching L=" << L << " g=(" << g0 << "," << g1 << ") Target=" << target_sum << " ---" << endl;
+    // 排序去重: g0 == g1 時兩池相同，a <= b 的對稱破缺變成 j >= i；
+    // 去重後每個 (i, j) 都是不同的行，輸出不必再 sort -u
+    sort(poolA.begin(), poolA.end());
+    poolA.erase(unique(poolA.begin(), poolA.end()), poolA.end());
+    sort(poolB.begin(), poolB.end());
+    poolB.erase(unique(poolB.begin(), poolB.end()), poolB.end());
+    bool same_pool = (g0 == g1) && (poolA == poolB);
 
-    auto start = high_resolution_clock::now();
-    ofstream res_out(out_path);
-    long long total = (long long)poolA.size() * poolB.size();
-    long long checked = 0;
-    int found = 0;
+    cout << "--- Matching L=" << L << " g=(" << g0 << "," << g1 << ") Target=" << target_sum
+         << " Mode=" << (join ? "join" : "cross") << " ---" << endl;
 
-    for (const auto& a : poolA) {
-        for (const auto& b : poolB) {
-            // Symmetry breaking for identical weights
-            if (g0 == g1 && a > b) { checked++; continue; }
+    auto start = high_resolution_clock::now();
+    MatchStats stats;
+    PairList pairs;
+    if (join) {
+        pairs = (L <= 127) ? run_join<int8_t>(poolA, poolB, same_pool, L, target_sum, stats)
+                           : run_join<int16_t>(poolA, poolB, same_pool, L, target_sum, stats);
+    } else {
+        pairs = (L <= 127) ? run_match<int8_t>(poolA, poolB, same_pool, L, target_sum, stats)
+                           : run_match<int16_t>(poolA, poolB, same_pool, L, target_sum, stats);
+    }
 
-            bool ok = true;
-            for (int u = 1; u <= L / 2; ++u) {
-                if (abs(calc_pacf(a, u, L) + calc_pacf(b, u, L)) > target_sum) {
-                    ok = false; break;
-                }
-            }
+    // In-process dedup (取代 system("sort -u"))
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    size_t found = pairs.size();
 
-            if (ok) {
-                res_out << a << "," << b << "\n";
-                found++;
-            }
-            if (++checked % 100000 == 0 || checked == total) {
-                cout << "\rProgress: " << fixed << setprecision(1) << (double)checked/total*100 << "% | Matches: " << found << flush;
-            }
-        }
+    ofstream res_out(out_path);
+    string buf;
+    buf.reserve(1 << 20);
+    for (const auto& p : pairs) {
+        buf += poolA[p.first];
+        buf += ',';
+        buf += poolB[p.second];
+        buf += '\n';
+        if (buf.size() >= (1 << 20)) { res_out << buf; buf.clear(); }
     }
+    res_out << buf;
     res_out.close();
 
-    // Sorting for uniqueness
-    if (found > 0) {
-        string cmd = "sort -u " + out_path + " -o " + out_path;
-        system(cmd.c_str());
-    }
-
     auto end = high_resolution_clock::now();
     auto diff = duration_cast<milliseconds>(end - start);
     cout << "\nDone. Found: " << found << " | Time: " << diff.count()/1000.0 << "s" << endl;
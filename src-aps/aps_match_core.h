@@ -0,0 +1,249 @@
+// ==========================================
+// Filename: aps_match_core.h
+// Optimization: Shared Matching Core (Packed ACF + Range Index Cross + Hash Join)
+// ==========================================
+//
+// aps_match 的配對核心抽成 header: AcfMatrix 每個池只建一次，
+// CrossMatcher / JoinMatcher 準備好索引後，row(i, hits, work) 處理 A 的一列。
+// aps_match 以 run_tiles 平行跑所有列；aps_sched / aps_stream 則把列區段當成自己的任務。
+
+#ifndef APS_MATCH_CORE_H
+#define APS_MATCH_CORE_H
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include "aps_range_index.h"
+#include "aps_parallel.h"
+
+/* =========================
+   Packed Half-Spectrum ACF
+   =========================
+   載入時每條候選只算一次 rho(1..L/2)，存成連續的 int8 (L <= 127) 或 int16 矩陣，
+   每列補零到 BLOCK 的倍數 (補的位置 a+b = 0，不影響判斷)。
+   配對只剩逐塊 add + compare，塊內無分支可被編譯器向量化，塊與塊之間提早離開。
+*/
+const int BLOCK = 16;
+
+template <typename T>
+struct AcfMatrix {
+    int stride = 0;
+    std::vector<T> data;
+
+    void build(const std::vector<std::string>& pool, int L) {
+        int H = L / 2;
+        stride = (H + BLOCK - 1) / BLOCK * BLOCK;
+        data.assign(pool.size() * stride, 0);
+        std::vector<int> v(L);
+        for (size_t r = 0; r < pool.size(); ++r) {
+            for (int i = 0; i < L; ++i) v[i] = (pool[r][i] == '+') ? 1 : -1;
+            T* row = &data[r * stride];
+            for (int u = 1; u <= H; ++u) {
+                int sum = 0;
+                for (int i = 0; i < L; ++i) sum += v[i] * v[(i + u < L) ? i + u : i + u - L];
+                row[u - 1] = (T)sum;
+            }
+        }
+    }
+
+    size_t rows() const { return stride ? data.size() / stride : 0; }
+    const T* row(size_t r) const { return &data[r * stride]; }
+};
+
+// 所有 u 都 |rho_a(u) + rho_b(u)| <= target
+template <typename T>
+inline bool pair_ok(const T* a, const T* b, int stride, int target) {
+    for (int u0 = 0; u0 < stride; u0 += BLOCK) {
+        int bad = 0;
+        for (int k = 0; k < BLOCK; ++k) {
+            int v = (int)a[u0 + k] + (int)b[u0 + k];
+            bad |= (v > target) | (v < -target);
+        }
+        if (bad) return false;
+    }
+    return true;
+}
+
+/* =========================
+   Tiled Parallel Driver
+   =========================
+   A 每 TILE_ROWS 列一塊 (這些列的 ACF 連續存放，整塊留在 L1)，交給 thread pool。
+   每塊的命中 (i, j) 存進自己的緩衝區；兩池已排序去重，依塊順序串接後
+   就是 "a,b" 行的字典序，不需要再 sort -u。
+*/
+const size_t TILE_ROWS = 64;
+
+using PairList = std::vector<std::pair<uint32_t, uint32_t>>;
+
+struct MatchStats {
+    std::atomic<size_t> rows_done{0};
+    std::atomic<long long> work{0};      // cross: 完整檢查次數 / join: 探測次數
+    std::atomic<long long> found{0};
+};
+
+// 第 [begin, end) 列的命中依列順序附加到 out
+template <typename Matcher>
+void match_rows(const Matcher& m, size_t begin, size_t end, PairList& out, long long& work) {
+    std::vector<uint32_t> hits;
+    for (size_t i = begin; i < end; ++i) {
+        hits.clear();
+        m.row(i, hits, work);
+        for (uint32_t j : hits) out.push_back({ (uint32_t)i, j });
+    }
+}
+
+template <typename Matcher>
+PairList run_tiles(const Matcher& m, size_t rows, const char* work_label, MatchStats& stats,
+                   int num_threads = aps_thread_count()) {
+    size_t num_tiles = (rows + TILE_ROWS - 1) / TILE_ROWS;
+    std::vector<PairList> tile_hits(num_tiles);
+
+    parallel_tiles(num_tiles, num_threads, [&](size_t tile, int tid) {
+        long long work = 0;
+        size_t end = std::min(rows, (tile + 1) * TILE_ROWS);
+        match_rows(m, tile * TILE_ROWS, end, tile_hits[tile], work);
+        stats.work += work;
+        stats.found += (long long)tile_hits[tile].size();
+        size_t done = (stats.rows_done += end - tile * TILE_ROWS);
+        if ((tid == 0 && tile % 16 == 0) || done == rows) {
+            std::cout << "\rProgress: " << std::fixed << std::setprecision(1)
+                      << (double)done / std::max<size_t>(rows, 1) * 100 << "% | " << work_label << ": "
+                      << stats.work.load() << " | Matches: " << stats.found.load() << std::flush;
+        }
+    });
+
+    PairList all;
+    size_t total = 0;
+    for (const auto& t : tile_hits) total += t.size();
+    all.reserve(total);
+    for (auto& t : tile_hits) {
+        all.insert(all.end(), t.begin(), t.end());
+        PairList().swap(t);
+    }
+    return all;
+}
+
+// 交叉配對: 對每個 a，B 上的可行區域是盒子 -rho_a(u) - T <= rho_b(u) <= -rho_a(u) + T，
+// 先用 RangeIndex 在幾個鑑別力最高的 lag 上剪掉盒子外的候選，再做完整檢查
+template <typename T>
+class CrossMatcher {
+public:
+    CrossMatcher(const AcfMatrix<T>& a, const AcfMatrix<T>& b, bool same_pool, int L, int target_sum)
+        : A(a), B(b), same(same_pool), H(L / 2), target(target_sum) {
+        index.build(B.data.data(), B.rows(), B.stride, H);
+    }
+
+    void row(size_t i, std::vector<uint32_t>& hits, long long& work) const {
+        const T* ra = A.row(i);
+        std::vector<int> lo(std::max(H, 1)), hi(std::max(H, 1));
+        for (int u = 0; u < H; ++u) {
+            lo[u] = -(int)ra[u] - target;
+            hi[u] = -(int)ra[u] + target;
+        }
+        // Symmetry breaking for identical weights: 兩池相同且已排序，a <= b 即 j >= i
+        size_t j0 = same ? i : 0;
+        index.query(lo.data(), hi.data(), [&](uint32_t j) {
+            if (j < j0) return;
+            work++;
+            if (pair_ok(ra, B.row(j), A.stride, target)) hits.push_back(j);
+        });
+        std::sort(hits.begin(), hits.end());
+    }
+
+private:
+    const AcfMatrix<T>& A;
+    const AcfMatrix<T>& B;
+    bool same;
+    int H, target;
+    RangeIndex<T> index;
+};
+
+/* =========================
+   Exact-Complement Hash Join
+   =========================
+   週期 ACF rho(u) ≡ L (mod 4)，所以 rho_a(u) + rho_b(u) ≡ 2L (mod 4):
+     奇數 L (Goal 1): |sum| <= 2 <=> sum = +-2，給定 a，rho_b(u) 只有 -rho_a(u) +- 2 兩種值
+     偶數 L (Goal 2): u < L/2 時 rho_b(u) = -rho_a(u)，只有 u = L/2 是 -rho_a +- 4
+   B 依前 K 個 lag 的值雜湊後排序；每個 a 只探測允許的補值 key
+   (奇數 2^K 個，偶數 1 個)，命中後再做完整驗證 (也處理雜湊碰撞)。
+   成本約 O(|A| * 2^K + |B| log|B| + 命中數)，不再是 |A| x |B|。
+*/
+const int JOIN_MAX_KEY_LAGS = 8;   // 奇數 L 每個 a 最多 256 次探測
+
+inline uint64_t key_hash(const int* v, int n) {
+    uint64_t h = 1469598103934665603ULL;   // FNV-1a
+    for (int i = 0; i < n; ++i) {
+        h ^= (uint64_t)(uint16_t)v[i];
+        h *= 1099511628211ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+// 偶數 L 的 Goal 2: u < L/2 全為 0，u = L/2 為 +-4
+template <typename T>
+inline bool goal2_ok(const T* a, const T* b, int H) {
+    for (int u = 0; u < H - 1; ++u) {
+        if ((int)a[u] + (int)b[u] != 0) return false;
+    }
+    int mid = (int)a[H - 1] + (int)b[H - 1];
+    return mid == 4 || mid == -4;
+}
+
+template <typename T>
+class JoinMatcher {
+public:
+    JoinMatcher(const AcfMatrix<T>& a, const AcfMatrix<T>& b, bool same_pool, int L, int target_sum)
+        : A(a), B(b), same(same_pool), odd(L % 2 != 0), H(L / 2), target(target_sum) {
+        K = odd ? std::min(H, JOIN_MAX_KEY_LAGS) : H - 1;
+        num_probes = odd ? (1u << K) : 1u;
+
+        table.resize(B.rows());
+        std::vector<int> key(std::max(K, 1));
+        for (size_t j = 0; j < table.size(); ++j) {
+            const T* rb = B.row(j);
+            for (int u = 0; u < K; ++u) key[u] = rb[u];
+            table[j] = { key_hash(key.data(), K), (uint32_t)j };
+        }
+        std::sort(table.begin(), table.end());
+    }
+
+    void row(size_t i, std::vector<uint32_t>& hits, long long& work) const {
+        const T* ra = A.row(i);
+        std::vector<int> probe(std::max(K, 1));
+        for (uint32_t m = 0; m < num_probes; ++m) {
+            for (int u = 0; u < K; ++u) {
+                probe[u] = -(int)ra[u];
+                if (odd) probe[u] += ((m >> u) & 1u) ? 2 : -2;
+            }
+            uint64_t h = key_hash(probe.data(), K);
+            auto range = std::equal_range(table.begin(), table.end(), std::make_pair(h, (uint32_t)0),
+                                          [](const std::pair<uint64_t, uint32_t>& x,
+                                             const std::pair<uint64_t, uint32_t>& y) { return x.first < y.first; });
+            for (auto it = range.first; it != range.second; ++it) {
+                uint32_t j = it->second;
+                if (same && j < i) continue;   // a <= b
+                const T* rb = B.row(j);
+                bool ok = odd ? pair_ok(ra, rb, A.stride, target) : goal2_ok(ra, rb, H);
+                if (ok) hits.push_back(j);
+            }
+        }
+        work += num_probes;
+
+        std::sort(hits.begin(), hits.end());
+        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    }
+
+private:
+    const AcfMatrix<T>& A;
+    const AcfMatrix<T>& B;
+    bool same, odd;
+    int H, K, target;
+    uint32_t num_probes;
+    std::vector<std::pair<uint64_t, uint32_t>> table;
+};
+
+#endif
@@ -0,0 +1,114 @@
+// ==========================================
+// Filename: aps_parallel.h
+// Optimization: Tile-Based Thread Pool for the APS Pipeline
+// ==========================================
+//
+// 工作切成固定大小的 tile，thread 以 atomic 計數器搶 tile (負載自動平均)。
+// 每個 tile 的輸出放在自己的緩衝區，最後依 tile 編號串接，
+// 結果順序與單執行緒完全相同。thread 數預設為硬體核心數，可用 APS_THREADS 覆寫。
+
+#ifndef APS_PARALLEL_H
+#define APS_PARALLEL_H
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+inline int aps_thread_count() {
+    const char* env = std::getenv("APS_THREADS");
+    int n = env ? std::atoi(env) : (int)std::thread::hardware_concurrency();
+    return std::max(1, n);
+}
+
+// fn(tile, tid) 對 tile = 0..num_tiles-1 各呼叫一次；tid 用來選 thread-local 狀態
+template <typename F>
+void parallel_tiles(size_t num_tiles, int num_threads, F&& fn) {
+    num_threads = (int)std::min<size_t>(std::max(1, num_threads), std::max<size_t>(num_tiles, 1));
+    std::atomic<size_t> next(0);
+    auto worker = [&](int tid) {
+        for (size_t t = next++; t < num_tiles; t = next++) fn(t, tid);
+    };
+    if (num_threads == 1) {
+        worker(0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) threads.emplace_back(worker, t);
+    for (auto& th : threads) th.join();
+}
+
+/* =========================
+   Task Graph (Shared Thread Pool)
+   =========================
+   靜態 DAG: 每個任務記下尚未完成的前置任務數，歸零就進 ready queue。
+   ready queue 依 priority (估計的下游工作量) 由大到小取，重的權重組先開跑，
+   尾端才剩小任務填空檔。
+*/
+class TaskGraph {
+public:
+    typedef std::function<void(int)> Fn;   // fn(tid)
+
+    size_t add(double priority, Fn fn) {
+        tasks_.push_back({ std::move(fn), priority, 0, {} });
+        return tasks_.size() - 1;
+    }
+
+    // after 必須等 before 完成
+    void depend(size_t before, size_t after) {
+        tasks_[before].next.push_back(after);
+        tasks_[after].waiting++;
+    }
+
+    size_t size() const { return tasks_.size(); }
+
+    // on_done(task, finished_count) 在持有鎖時呼叫 (可用來印進度)
+    void run(int num_threads, const std::function<void(size_t, size_t)>& on_done = nullptr) {
+        for (size_t t = 0; t < tasks_.size(); t++) if (tasks_[t].waiting == 0) ready_.push({ tasks_[t].priority, t });
+        finished_ = 0;
+
+        auto worker = [&](int tid) {
+            std::unique_lock<std::mutex> lock(mu_);
+            while (true) {
+                cv_.wait(lock, [&] { return !ready_.empty() || finished_ == tasks_.size(); });
+                if (ready_.empty()) return;
+                size_t t = ready_.top().second;
+                ready_.pop();
+                lock.unlock();
+                tasks_[t].fn(tid);
+                Fn().swap(tasks_[t].fn);    // 釋放 closure 持有的資源
+                lock.lock();
+                for (size_t n : tasks_[t].next) {
+                    if (--tasks_[n].waiting == 0) ready_.push({ tasks_[n].priority, n });
+                }
+                finished_++;
+                if (on_done) on_done(t, finished_);
+                cv_.notify_all();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < std::max(1, num_threads); t++) threads.emplace_back(worker, t);
+        for (auto& th : threads) th.join();
+    }
+
+private:
+    struct Task {
+        Fn fn;
+        double priority;
+        int waiting;
+        std::vector<size_t> next;
+    };
+    std::vector<Task> tasks_;
+    std::priority_queue<std::pair<double, size_t>> ready_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    size_t finished_ = 0;
+};
+
+#endif
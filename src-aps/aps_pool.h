@@ -0,0 +1,186 @@
+// ==========================================
+// Filename: aps_pool.h
+// Optimization: Bit-Packed Out-of-Core Candidate Pool
+// ==========================================
+//
+// aps_dfs 的候選序列不再放在 RAM 裡的 vector<Seq>，而是:
+//   <base>.c<k>.bin : 第 k 個 thread 的 chunk 檔，每條序列一個 uint64_t
+//                     (bit i = 1 表示 s[i] = -1，與 lib 的 int_to_seq 相同)
+//   <base>.idx      : 固定大小的 Header + 每個前綴任務一筆 TaskEntry，可直接 mmap
+// 依 TaskEntry 的順序讀出 == 單執行緒 DFS 的輸出順序。
+
+#ifndef APS_POOL_H
+#define APS_POOL_H
+
+#include "../lib/pacp_mmap.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace ApsPool {
+
+    constexpr char MAGIC[8] = { 'A', 'P', 'S', 'P', 'O', 'O', 'L', '1' };
+    constexpr int MAX_L = 64;
+
+    struct Header {
+        char magic[8];
+        uint32_t L;
+        uint32_t g;
+        uint32_t num_chunks;
+        uint32_t num_tasks;
+        uint64_t total;
+    };
+
+    struct TaskEntry {
+        uint32_t task;
+        uint32_t chunk;
+        uint64_t offset;   // 以 uint64_t 為單位
+        uint64_t count;
+    };
+
+    static_assert(sizeof(Header) == 32, "Header must stay mmap-compatible");
+    static_assert(sizeof(TaskEntry) == 24, "TaskEntry must stay mmap-compatible");
+
+    inline std::string index_path(const std::string& base) { return base + ".idx"; }
+    inline std::string chunk_path(const std::string& base, uint32_t chunk) {
+        return base + ".c" + std::to_string(chunk) + ".bin";
+    }
+
+    inline uint64_t pack(const std::vector<int>& s) {
+        uint64_t w = 0;
+        for (size_t i = 0; i < s.size(); i++) if (s[i] < 0) w |= (1ULL << i);
+        return w;
+    }
+
+    inline std::string unpack_string(uint64_t w, int L) {
+        std::string s(L, '+');
+        for (int i = 0; i < L; i++) if ((w >> i) & 1ULL) s[i] = '-';
+        return s;
+    }
+
+    // L > MAX_L 時池不 bit-pack，直接存 '+'/'-' 文字 (與 unpack_string 同格式)
+    inline std::string text(const std::vector<int>& s) {
+        std::string t(s.size(), '+');
+        for (size_t i = 0; i < s.size(); i++) if (s[i] < 0) t[i] = '-';
+        return t;
+    }
+
+    // 每個 thread 一個: 固定大小的 arena 裝滿才 fwrite，DFS 葉節點不做任何配置
+    // 寫入失敗 (磁碟滿等) 會記在 failed_，close() 回傳 false，呼叫端不可寫 index
+    class ChunkWriter {
+    public:
+        static constexpr size_t ARENA_WORDS = 1 << 16;
+
+        bool open(const std::string& path) {
+            f_ = std::fopen(path.c_str(), "wb");
+            arena_.reset(new uint64_t[ARENA_WORDS]);
+            used_ = 0;
+            flushed_ = 0;
+            failed_ = (f_ == nullptr);
+            return f_ != nullptr;
+        }
+
+        void push(uint64_t w) {
+            arena_[used_++] = w;
+            if (used_ == ARENA_WORDS) flush();
+        }
+
+        // 目前已寫入 (含 arena 中) 的序列數
+        uint64_t position() const { return flushed_ + used_; }
+
+        void flush() {
+            if (used_ && f_ && std::fwrite(arena_.get(), sizeof(uint64_t), used_, f_) != used_) failed_ = true;
+            flushed_ += used_;
+            used_ = 0;
+        }
+
+        bool close() {
+            flush();
+            if (f_ && std::fclose(f_) != 0) failed_ = true;
+            f_ = nullptr;
+            return !failed_;
+        }
+
+        ~ChunkWriter() { close(); }
+
+    private:
+        std::FILE* f_ = nullptr;
+        std::unique_ptr<uint64_t[]> arena_;
+        size_t used_ = 0;
+        uint64_t flushed_ = 0;
+        bool failed_ = false;
+    };
+
+    inline bool write_index(const std::string& base, int L, int g, uint32_t num_chunks,
+                            const std::vector<TaskEntry>& entries) {
+        Header h;
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.L = (uint32_t)L;
+        h.g = (uint32_t)g;
+        h.num_chunks = num_chunks;
+        h.num_tasks = (uint32_t)entries.size();
+        h.total = 0;
+        for (const auto& e : entries) h.total += e.count;
+
+        std::FILE* f = std::fopen(index_path(base).c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+        if (ok && !entries.empty())
+            ok = std::fwrite(entries.data(), sizeof(TaskEntry), entries.size(), f) == entries.size();
+        if (std::fclose(f) != 0) ok = false;
+        return ok;
+    }
+
+    // 以 mmap 讀取整個池 (index + 所有 chunk)
+    class Reader {
+    public:
+        bool open(const std::string& base) {
+            if (!idx_.open(index_path(base)) || idx_.size() < sizeof(Header)) return false;
+            const Header* h = header();
+            if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+            if (idx_.size() < sizeof(Header) + (size_t)h->num_tasks * sizeof(TaskEntry)) return false;
+
+            chunks_.clear();
+            for (uint32_t c = 0; c < h->num_chunks; c++) {
+                chunks_.emplace_back(new MappedFile());
+                if (!chunks_.back()->open(chunk_path(base, c))) return false;
+            }
+
+            // 每個任務都必須落在自己的 chunk 內 (chunk 被截斷或 .idx 過期時拒絕，而不是讀出 mmap 範圍)
+            const TaskEntry* e = entries();
+            uint64_t total = 0;
+            for (uint32_t t = 0; t < h->num_tasks; t++) {
+                if (e[t].chunk >= h->num_chunks) return false;
+                uint64_t words = chunks_[e[t].chunk]->size() / sizeof(uint64_t);
+                if (e[t].offset > words || e[t].count > words - e[t].offset) return false;
+                total += e[t].count;
+            }
+            return total == h->total;
+        }
+
+        const Header* header() const { return idx_.as<Header>(); }
+        const TaskEntry* entries() const {
+            return reinterpret_cast<const TaskEntry*>(idx_.data() + sizeof(Header));
+        }
+
+        // 依任務順序走訪每條序列
+        template <typename F>
+        void for_each(F&& fn) const {
+            const Header* h = header();
+            const TaskEntry* e = entries();
+            for (uint32_t t = 0; t < h->num_tasks; t++) {
+                const uint64_t* words = chunks_[e[t].chunk]->as<uint64_t>() + e[t].offset;
+                for (uint64_t i = 0; i < e[t].count; i++) fn(words[i]);
+            }
+        }
+
+    private:
+        MappedFile idx_;
+        std::vector<std::unique_ptr<MappedFile>> chunks_;
+    };
+}
+
+#endif
@@ -0,0 +1,102 @@
+// ==========================================
+// Filename: aps_queue.h
+// Optimization: Bounded Lock-Free MPMC Queue (Stage-to-Stage Streaming)
+// ==========================================
+//
+// 固定容量的環形緩衝區 (容量為 2 的冪次)，每個 slot 帶一個序號:
+//   seq == pos       : slot 空著，可寫入第 pos 個元素
+//   seq == pos + 1   : slot 已寫入，可讀出第 pos 個元素
+// producer / consumer 各自以 CAS 搶位置，沒有 mutex。
+// 滿了 push 就讓出 CPU 等待 (背壓)，所以上游再快，佇列佔用的記憶體也固定。
+// close() 由最後一個 producer 呼叫，consumer 讀空之後 pop 回傳 false。
+
+#ifndef APS_QUEUE_H
+#define APS_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity_pow2) {
+        size_t cap = 1;
+        while (cap < capacity_pow2) cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (size_t i = 0; i < cap; i++) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(const T& v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& s = slots_[pos & mask_];
+            size_t seq = s.seq.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.value = v;
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;   // 滿了
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& v) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& s = slots_[pos & mask_];
+            size_t seq = s.seq.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    v = s.value;
+                    s.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;   // 空的
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 阻塞版本: 滿了就 yield 等 consumer
+    void push(const T& v) {
+        while (!try_push(v)) std::this_thread::yield();
+    }
+
+    // 阻塞版本: 空了就等，佇列已 close 且讀空時回傳 false
+    bool pop(T& v) {
+        while (true) {
+            if (try_pop(v)) return true;
+            if (closed_.load(std::memory_order_acquire)) return try_pop(v);
+            std::this_thread::yield();
+        }
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+    std::atomic<bool> closed_{false};
+};
+
+#endif
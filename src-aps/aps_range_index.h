@@ -0,0 +1,112 @@
+// ==========================================
+// Filename: aps_range_index.h
+// Optimization: Multi-Level Sorted Range Index (Box Queries)
+// ==========================================
+//
+// 不等式配對 (|rho_a + rho_b| <= T、|psd_a + psd_b - 2L| <= slack) 對每個 a 都是
+// B 上的一個「盒子」查詢: 每一維 lo[d] <= b[d] <= hi[d]。
+// 做法: 挑變異數最大的幾維當索引層，B 依這幾維做字典序排序；
+// 固定前幾層的值之後，下一層在子區間內仍是排序好的，所以可以逐層二分搜尋，
+// 只走進落在 [lo, hi] 內的值，盒子外的候選整批跳過。
+// 索引層以外的維度交給呼叫端做完整檢查。
+
+#ifndef APS_RANGE_INDEX_H
+#define APS_RANGE_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+template <typename T>
+class RangeIndex {
+public:
+    static constexpr int DEFAULT_LEVELS = 4;
+
+    // rows: n 列，每列 stride 個元素，只考慮前 dims 維
+    void build(const T* rows, size_t n, int stride, int dims, int max_levels = DEFAULT_LEVELS) {
+        n_ = n;
+        levels_ = std::min(dims, max_levels);
+
+        // 依變異數挑最有鑑別力的維度
+        std::vector<std::pair<double, int>> spread(dims);
+        for (int d = 0; d < dims; ++d) {
+            double sum = 0, sum2 = 0;
+            for (size_t i = 0; i < n; ++i) {
+                double v = (double)rows[i * stride + d];
+                sum += v;
+                sum2 += v * v;
+            }
+            double mean = n ? sum / n : 0;
+            spread[d] = { n ? sum2 / n - mean * mean : 0, d };
+        }
+        std::stable_sort(spread.begin(), spread.end(),
+                         [](const std::pair<double, int>& x, const std::pair<double, int>& y) { return x.first > y.first; });
+        dim_.resize(levels_);
+        for (int l = 0; l < levels_; ++l) dim_[l] = spread[l].second;
+
+        perm_.resize(n);
+        std::iota(perm_.begin(), perm_.end(), 0u);
+        std::sort(perm_.begin(), perm_.end(), [&](uint32_t x, uint32_t y) {
+            for (int l = 0; l < levels_; ++l) {
+                T vx = rows[(size_t)x * stride + dim_[l]], vy = rows[(size_t)y * stride + dim_[l]];
+                if (vx != vy) return vx < vy;
+            }
+            return x < y;
+        });
+
+        // 索引鍵依排序後的順序連續存放
+        keys_.resize(n * levels_);
+        for (size_t i = 0; i < n; ++i) {
+            for (int l = 0; l < levels_; ++l) keys_[i * levels_ + l] = rows[(size_t)perm_[i] * stride + dim_[l]];
+        }
+    }
+
+    int levels() const { return levels_; }
+    const std::vector<int>& dims() const { return dim_; }
+
+    // lo/hi 以原始維度編號索引；fn(j) 收到所有索引層都落在盒子內的列
+    template <typename F>
+    void query(const int* lo, const int* hi, F&& fn) const {
+        if (n_ == 0) return;
+        descend(0, 0, n_, lo, hi, fn);
+    }
+
+private:
+    size_t n_ = 0;
+    int levels_ = 0;
+    std::vector<int> dim_;
+    std::vector<uint32_t> perm_;
+    std::vector<T> keys_;
+
+    T key(size_t i, int l) const { return keys_[i * levels_ + l]; }
+
+    // [begin, end) 中第 l 層 >= v 的第一個位置 (該層在子區間內已排序)
+    size_t lower(size_t begin, size_t end, int l, long long v) const {
+        while (begin < end) {
+            size_t mid = begin + (end - begin) / 2;
+            if ((long long)key(mid, l) < v) begin = mid + 1;
+            else end = mid;
+        }
+        return begin;
+    }
+
+    template <typename F>
+    void descend(int l, size_t begin, size_t end, const int* lo, const int* hi, F& fn) const {
+        if (l == levels_) {
+            for (size_t i = begin; i < end; ++i) fn(perm_[i]);
+            return;
+        }
+        int d = dim_[l];
+        size_t i = lower(begin, end, l, lo[d]);
+        while (i < end && (long long)key(i, l) <= hi[d]) {
+            T v = key(i, l);
+            size_t j = lower(i, end, l, (long long)v + 1);
+            descend(l + 1, i, j, lo, hi, fn);
+            i = j;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,181 @@
+// ==========================================
+// Filename: aps_sample.h
+// Optimization: Weight-Constrained Random Sampling (Incremental DFT + ACF)
+// ==========================================
+//
+// 中大型 L (60~100) 的窮舉 DFS 無法完成，改成抽樣:
+//   1. mix = 0 (預設): 每次都對固定的多重集 (g 個 +1、L-g 個 -1) 重新洗牌，
+//      各次抽樣彼此獨立，且在權重為 g 的序列上「恰好」均勻；DFT / ACF 整條重算 O(L^2)
+//   2. mix > 0: 改走 random transposition walk，每次抽樣之間做 mix 次換位
+//      (一個 +1 與一個 -1 交換，權重不變)。相鄰樣本彼此相關，分佈只是「近似」均勻
+//      (mix 越大越接近)；換位只動兩個位置: DFT 每個 k 修正兩項 O(L/2)，ACF 每個 u 修正四項 O(L/2)
+//      獨立抽樣與 mix = L 的走法成本同階，只有在 mix 遠小於 L 時 walk 才比較快
+//   4. 通過與 DFS 葉節點相同的檢查 (|F_k|^2 <= 2L + slack、|rho(u)| <= MAX_RHO) 才收下，
+//      並轉成滿足 prefix_canonical(s, L) 的代表元 (最小循環位移)，與 DFS 池的寫法一致
+// walk 模式的 DFT 以 double 累加，每 REFRESH 次換位重算一次避免誤差累積。
+
+#ifndef APS_SAMPLE_H
+#define APS_SAMPLE_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace ApsSample {
+
+    const double PI = std::acos(-1.0);
+    const int PSD_SLACK = 10;          // 與 ApsGen::PSD_SLACK 相同
+    const int REFRESH = 4096;
+
+    struct Stats {
+        long long drawn = 0;
+        long long accepted = 0;
+        long long spectral_reject = 0;
+        long long acf_reject = 0;
+        long long periodic_reject = 0;   // 有週期的序列 (DFS 的 prefix_canonical 也會丟掉)
+    };
+
+    class Sampler {
+    public:
+        Sampler(int L, int g, int max_rho, uint64_t seed, int psd_slack = PSD_SLACK)
+            : L_(L), H_(L / 2), g_(g), max_rho_(max_rho), rng_(seed) {
+            tw_cos_.resize(L);
+            tw_sin_.resize(L);
+            for (int m = 0; m < L; m++) {
+                tw_cos_[m] = std::cos(2.0 * PI * m / L);
+                tw_sin_[m] = -std::sin(2.0 * PI * m / L);
+            }
+            psd_bound_ = 2.0 * L + psd_slack + 0.5;
+            s_.assign(L, -1);
+            for (int i = 0; i < g; i++) s_[i] = 1;
+            std::shuffle(s_.begin(), s_.end(), rng_);
+            recompute();
+        }
+
+        // mix = 0: 獨立均勻抽一條；mix > 0: 走 mix 步換位後取目前的序列 (與上一條相關)
+        // 通過檢查時 out 為 canonical 代表元 ('+'/'-' 字串)
+        bool draw(int mix, std::string& out, Stats& st) {
+            if (g_ > 0 && g_ < L_) {
+                if (mix <= 0) {
+                    std::shuffle(s_.begin(), s_.end(), rng_);
+                    recompute();
+                } else {
+                    for (int m = 0; m < mix; m++) step();
+                }
+            }
+            st.drawn++;
+
+            for (int k = 1; k <= H_; k++) {
+                if (re_[k] * re_[k] + im_[k] * im_[k] > psd_bound_) {
+                    st.spectral_reject++;
+                    return false;
+                }
+            }
+            if (max_rho_ > 0) {
+                for (int u = 1; u <= H_; u++) {
+                    if (std::abs(acf_[u]) > max_rho_) {
+                        st.acf_reject++;
+                        return false;
+                    }
+                }
+            }
+            if (!canonical(out)) {
+                st.periodic_reject++;
+                return false;
+            }
+            st.accepted++;
+            return true;
+        }
+
+    private:
+        int L_, H_, g_, max_rho_;
+        std::mt19937_64 rng_;
+        std::vector<int> s_;
+        std::vector<double> tw_cos_, tw_sin_, re_, im_;
+        std::vector<int> acf_;            // rho(0..L/2)
+        double psd_bound_;
+        int since_refresh_ = 0;
+
+        void recompute() {
+            re_.assign(H_ + 1, 0.0);
+            im_.assign(H_ + 1, 0.0);
+            for (int k = 0; k <= H_; k++) {
+                int m = 0;
+                for (int n = 0; n < L_; n++) {
+                    re_[k] += s_[n] * tw_cos_[m];
+                    im_[k] += s_[n] * tw_sin_[m];
+                    m += k;
+                    if (m >= L_) m -= L_;
+                }
+            }
+            acf_.assign(H_ + 1, 0);
+            for (int u = 1; u <= H_; u++) {
+                int sum = 0;
+                for (int i = 0; i < L_; i++) sum += s_[i] * s_[(i + u) % L_];
+                acf_[u] = sum;
+            }
+            since_refresh_ = 0;
+        }
+
+        int at(int i) const { return s_[i < 0 ? i + L_ : (i >= L_ ? i - L_ : i)]; }
+
+        // 交換一個 +1 (位置 i) 與一個 -1 (位置 j)
+        void step() {
+            std::uniform_int_distribution<int> pos(0, L_ - 1);
+            int i, j;
+            do { i = pos(rng_); } while (s_[i] != 1);
+            do { j = pos(rng_); } while (s_[j] != -1);
+
+            // ACF: 只有包含 i 或 j 的項會變，先扣掉舊值再加回新值
+            for (int u = 1; u <= H_; u++) acf_[u] -= touched(i, j, u);
+            s_[i] = -1;
+            s_[j] = 1;
+            for (int u = 1; u <= H_; u++) acf_[u] += touched(i, j, u);
+
+            // DFT: F_k += (-2) W^(k*i) + 2 W^(k*j)
+            int mi = 0, mj = 0;
+            for (int k = 0; k <= H_; k++) {
+                re_[k] += -2.0 * tw_cos_[mi] + 2.0 * tw_cos_[mj];
+                im_[k] += -2.0 * tw_sin_[mi] + 2.0 * tw_sin_[mj];
+                mi += i;
+                if (mi >= L_) mi -= L_;
+                mj += j;
+                if (mj >= L_) mj -= L_;
+            }
+            if (++since_refresh_ >= REFRESH) recompute();
+        }
+
+        // rho(u) 中含位置 i 或 j 的項之和 (i 與 j 互為鄰居時該項只算一次)
+        int touched(int i, int j, int u) const {
+            int sum = at(i) * at(i + u) + at(i) * at(i - u);
+            sum += at(j) * at(j + u) + at(j) * at(j - u);
+            int d = j - i;
+            if (d < 0) d += L_;
+            if (d == u) sum -= at(i) * at(j);              // (i, i+u) == (j-u, j)
+            if (d == L_ - u) sum -= at(j) * at(i);         // (j, j+u) == (i-u, i)
+            return sum;
+        }
+
+        // prefix_canonical 的代表元: 所有循環位移中 (以 -1 < +1 比較) 最小者，有週期則回傳 false
+        bool canonical(std::string& out) const {
+            int best = 0;
+            for (int sh = 1; sh < L_; sh++) {
+                for (int i = 0; i < L_; i++) {
+                    int a = s_[(sh + i) % L_], b = s_[(best + i) % L_];
+                    if (a < b) { best = sh; break; }
+                    if (a > b) break;
+                    if (i == L_ - 1) return false;   // 位移後相同: 有週期
+                }
+            }
+            out.assign(L_, '+');
+            for (int i = 0; i < L_; i++) if (s_[(best + i) % L_] < 0) out[i] = '-';
+            return true;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,366 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <set>
+#include <memory>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include "aps_gen.h"
+#include "aps_pool.h"
+#include "aps_match_core.h"
+#include "aps_canon.h"
+#include "aps_parallel.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+/* =========================
+   All-Weight-Pairs Scheduler
+   =========================
+   ./aps_sched L max_rho [cross|join]
+   讀入 results/L/L_weight.txt 的「所有」權重組 (driver.sh 以前只跑第一組)，
+   在同一個程序內以 TaskGraph 排程:
+
+     gen(g, part) --> pool(g) --> prep(g0,g1) --> match(g0,g1, part) --> finish(g0,g1)
+
+   - 每個用到的 g 只產生一次候選池 (DFS 前綴切成數個 part)，
+     池與其 ACF 矩陣由所有用到 g 的權重組共用，最後一個使用者完成後釋放
+   - 優先序以 C(L,g) 估計池大小: gen 的權重 = 它餵給的所有配對的 C(L,g0)*C(L,g1) 總和，
+     所以最重的權重組先開跑，小的權重組在尾端填滿空閒的 thread
+   - 輸出與逐組跑 aps_dfs / aps_match / aps_filter 相同:
+     results/L/g0_g1/{cand_g*.txt, match_result.txt, unique_result.txt} + results/L/summary.txt
+   - L <= 64 葉節點 bit-pack、canonical 用 uint64；L > 64 改存文字、canonical 用 canonical_string
+     (與 aps_dfs / aps_filter 的 L > 64 路徑相同)。ACF 型別同 aps_match: L <= 127 int8，其餘 int16
+*/
+
+// 一個 g 的共用候選池
+template <typename AcfT>
+struct WeightPool {
+    int g = 0;
+    vector<vector<uint64_t>> parts;   // 每個 DFS part 的葉節點 (ApsPool::pack)，依 part 順序 == DFS 順序
+    vector<vector<string>> text_parts; // L > 64: 同上，直接存文字
+    vector<string> dfs_order;         // cand_g*.txt 的內容 (與 aps_dfs 相同)
+    vector<string> sorted;            // 排序去重後 (與 aps_match 載入後相同)
+    vector<uint64_t> canon;           // sorted[i] 的 canonical form (aps_filter)
+    vector<string> canon_text;        // L > 64: sorted[i] 的 canonical_string
+    AcfMatrix<AcfT> acf;
+    atomic<int> users{0};             // 尚未完成的權重組數
+
+    void release() {
+        vector<vector<uint64_t>>().swap(parts);
+        vector<vector<string>>().swap(text_parts);
+        vector<string>().swap(dfs_order);
+        vector<string>().swap(sorted);
+        vector<uint64_t>().swap(canon);
+        vector<string>().swap(canon_text);
+        vector<AcfT>().swap(acf.data);
+    }
+};
+
+// 一個權重組的配對狀態
+template <typename AcfT>
+struct PairJob {
+    int g0 = 0, g1 = 0;
+    string dir;
+    WeightPool<AcfT>* A = nullptr;
+    WeightPool<AcfT>* B = nullptr;
+    bool same = false;
+    unique_ptr<CrossMatcher<AcfT>> cross;
+    unique_ptr<JoinMatcher<AcfT>> join;
+    vector<PairList> parts;
+    size_t raw = 0, uniq = 0;
+    double seconds = 0;
+    steady_clock::time_point start;
+};
+
+double binom(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    double r = 1;
+    for (int i = 1; i <= k; i++) r = r * (n - k + i) / i;
+    return r;
+}
+
+bool write_lines(const string& path, const vector<string>& lines) {
+    ofstream out(path);
+    if (!out) return false;
+    string buf;
+    buf.reserve(1 << 20);
+    for (const auto& s : lines) {
+        buf += s;
+        buf += '\n';
+        if (buf.size() >= (1 << 20)) { out << buf; buf.clear(); }
+    }
+    out << buf;
+    return (bool)out;
+}
+
+template <typename AcfT>
+int schedule(int L, int max_rho, bool use_join) {
+    typedef WeightPool<AcfT> Pool;
+    typedef PairJob<AcfT> Job;
+    const bool wide = (L > ApsPool::MAX_L);
+    int target_sum = (L % 2 != 0) ? 2 : 4;
+
+    // 1. 權重組
+    string root = "results/" + to_string(L);
+    string w_path = root + "/" + to_string(L) + "_weight.txt";
+    ifstream wf(w_path);
+    if (!wf) {
+        cerr << "Error: cannot read " << w_path << " (run aps_weight first)\n";
+        return 1;
+    }
+    vector<pair<int, int>> weight_pairs;
+    set<pair<int, int>> seen;
+    string line;
+    while (getline(wf, line)) {
+        istringstream ss(line);
+        int g0, g1;
+        if (!(ss >> g0 >> g1)) continue;
+        if (g0 < 0 || g1 < 0 || g0 > L || g1 > L) continue;
+        if (seen.insert({ g0, g1 }).second) weight_pairs.push_back({ g0, g1 });
+    }
+    if (weight_pairs.empty()) {
+        cerr << "Error: no weight pairs in " << w_path << "\n";
+        return 1;
+    }
+
+    int num_threads = aps_thread_count();
+    auto t0 = steady_clock::now();
+
+    // 2. 每個 g 一個共用池
+    map<int, unique_ptr<Pool>> pools;
+    map<int, double> gen_priority;
+    for (const auto& wp : weight_pairs) {
+        double cost = binom(L, wp.first) * binom(L, wp.second);
+        for (int g : { wp.first, wp.second }) {
+            if (!pools.count(g)) {
+                pools[g].reset(new Pool());
+                pools[g]->g = g;
+            }
+            gen_priority[g] += cost;
+        }
+        pools[wp.first]->users++;
+        if (wp.second != wp.first) pools[wp.second]->users++;
+    }
+
+    cout << "-------------------------------------------" << endl;
+    cout << " APS Scheduler | L=" << L << " | Pairs: " << weight_pairs.size() << " | Pools: " << pools.size()
+         << " | Threads: " << num_threads << " | Mode: " << (use_join ? "join" : "cross") << endl;
+
+    TaskGraph graph;
+    map<int, size_t> pool_task;
+    vector<unique_ptr<ApsGen::Generator>> gens;
+    const int gen_parts_per_thread = 4;
+
+    for (auto& kv : pools) {
+        int g = kv.first;
+        Pool* wp = kv.second.get();
+        double prio = gen_priority[g];
+
+        ApsGen::Config cfg;
+        cfg.L = L;
+        cfg.g = g;
+        cfg.max_rho = max_rho;
+        gens.emplace_back(new ApsGen::Generator(cfg));
+        const ApsGen::Generator* gen = gens.back().get();
+
+        // 前綴切分很便宜，先在主執行緒做完，part 數才能靜態決定
+        int depth = gen->split_depth(num_threads);
+        auto prefixes = make_shared<vector<ApsGen::Prefix>>(gen->split(depth));
+        size_t num_parts = min<size_t>(prefixes->size(), (size_t)num_threads * gen_parts_per_thread);
+        num_parts = max<size_t>(num_parts, 1);
+        if (wide) wp->text_parts.resize(num_parts);
+        else wp->parts.resize(num_parts);
+
+        size_t finalize = graph.add(prio, [wp, L, wide](int) {
+            for (auto& p : wp->parts) {
+                for (uint64_t w : p) wp->dfs_order.push_back(ApsPool::unpack_string(w, L));
+                vector<uint64_t>().swap(p);
+            }
+            for (auto& p : wp->text_parts) {
+                for (auto& t : p) wp->dfs_order.push_back(std::move(t));
+                vector<string>().swap(p);
+            }
+            wp->sorted = wp->dfs_order;
+            sort(wp->sorted.begin(), wp->sorted.end());
+            wp->sorted.erase(unique(wp->sorted.begin(), wp->sorted.end()), wp->sorted.end());
+            if (wide) {
+                wp->canon_text.resize(wp->sorted.size());
+                for (size_t i = 0; i < wp->sorted.size(); i++) wp->canon_text[i] = canonical_string(wp->sorted[i].data(), L);
+            } else {
+                wp->canon.resize(wp->sorted.size());
+                for (size_t i = 0; i < wp->sorted.size(); i++) {
+                    uint64_t w = 0;
+                    pack_seq(wp->sorted[i].data(), L, w);
+                    wp->canon[i] = get_canonical(w, L);
+                }
+            }
+            wp->acf.build(wp->sorted, L);
+        });
+        pool_task[g] = finalize;
+
+        for (size_t part = 0; part < num_parts; part++) {
+            size_t t = graph.add(prio, [wp, gen, prefixes, depth, part, num_parts, wide](int) {
+                ApsGen::Generator::State st(*gen);
+                auto on_leaf = [&](ApsGen::Generator::State& cur) {
+                    if (wide) wp->text_parts[part].push_back(ApsPool::text(cur.s));
+                    else wp->parts[part].push_back(ApsPool::pack(cur.s));
+                };
+                size_t begin = prefixes->size() * part / num_parts;
+                size_t end = prefixes->size() * (part + 1) / num_parts;
+                for (size_t i = begin; i < end; i++) gen->run_prefix(st, (*prefixes)[i], depth, on_leaf);
+            });
+            graph.depend(t, finalize);
+        }
+    }
+
+    // 3. 每個權重組: prep (寫 cand 檔、建索引) -> match parts -> finish (去重、輸出)
+    vector<unique_ptr<Job>> jobs;
+    const int match_parts_per_thread = 4;
+    size_t match_parts = (size_t)num_threads * match_parts_per_thread;
+
+    for (const auto& wpair : weight_pairs) {
+        jobs.emplace_back(new Job());
+        Job* job = jobs.back().get();
+        job->g0 = wpair.first;
+        job->g1 = wpair.second;
+        job->dir = root + "/" + to_string(job->g0) + "_" + to_string(job->g1);
+        job->A = pools[job->g0].get();
+        job->B = pools[job->g1].get();
+        job->parts.resize(match_parts);
+        double prio = binom(L, job->g0) * binom(L, job->g1);
+
+        size_t prep = graph.add(prio, [job, L, target_sum, use_join](int) {
+            job->start = steady_clock::now();
+            error_code ec;
+            fs::create_directories(job->dir, ec);
+            write_lines(job->dir + "/cand_g" + to_string(job->g0) + ".txt", job->A->dfs_order);
+            if (job->g1 != job->g0) write_lines(job->dir + "/cand_g" + to_string(job->g1) + ".txt", job->B->dfs_order);
+
+            job->same = (job->A == job->B);
+            if (use_join) job->join.reset(new JoinMatcher<AcfT>(job->A->acf, job->B->acf, job->same, L, target_sum));
+            else job->cross.reset(new CrossMatcher<AcfT>(job->A->acf, job->B->acf, job->same, L, target_sum));
+        });
+        graph.depend(pool_task[job->g0], prep);
+        graph.depend(pool_task[job->g1], prep);
+
+        size_t finish = graph.add(prio, [job, L, wide](int) {
+            PairList pairs;
+            for (auto& p : job->parts) {
+                pairs.insert(pairs.end(), p.begin(), p.end());
+                PairList().swap(p);
+            }
+            pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+            job->raw = pairs.size();
+
+            // match_result.txt (與 aps_match 相同的順序)
+            ofstream res_out(job->dir + "/match_result.txt");
+            string buf;
+            buf.reserve(1 << 20);
+            vector<PairKey> keys;
+            vector<string> text_keys;
+            if (wide) text_keys.reserve(pairs.size());
+            else keys.reserve(pairs.size());
+            for (const auto& p : pairs) {
+                buf += job->A->sorted[p.first];
+                buf += ',';
+                buf += job->B->sorted[p.second];
+                buf += '\n';
+                if (buf.size() >= (1 << 20)) { res_out << buf; buf.clear(); }
+                if (wide) text_keys.push_back(canonical_pair_string(job->A->canon_text[p.first], job->B->canon_text[p.second]));
+                else keys.push_back(canonical_pair(job->A->canon[p.first], job->B->canon[p.second]));
+            }
+            res_out << buf;
+            res_out.close();
+
+            // unique_result.txt (與 aps_filter 相同)
+            sort(keys.begin(), keys.end());
+            keys.erase(unique(keys.begin(), keys.end()), keys.end());
+            sort(text_keys.begin(), text_keys.end());
+            text_keys.erase(unique(text_keys.begin(), text_keys.end()), text_keys.end());
+            job->uniq = wide ? text_keys.size() : keys.size();
+            if (!pairs.empty()) {
+                ofstream uniq_out(job->dir + "/unique_result.txt");
+                for (const auto& k : keys) uniq_out << unpack_seq(k.first, L) << "," << unpack_seq(k.second, L) << "\n";
+                for (const auto& k : text_keys) uniq_out << k << "\n";
+            }
+
+            job->cross.reset();
+            job->join.reset();
+            if (--job->A->users == 0) job->A->release();
+            if (job->B != job->A && --job->B->users == 0) job->B->release();
+            job->seconds = duration_cast<milliseconds>(steady_clock::now() - job->start).count() / 1000.0;
+        });
+
+        for (size_t part = 0; part < match_parts; part++) {
+            size_t t = graph.add(prio / match_parts, [job, part, match_parts](int) {
+                size_t rows = job->A->sorted.size();
+                size_t begin = rows * part / match_parts;
+                size_t end = rows * (part + 1) / match_parts;
+                long long work = 0;
+                if (job->join) match_rows(*job->join, begin, end, job->parts[part], work);
+                else match_rows(*job->cross, begin, end, job->parts[part], work);
+            });
+            graph.depend(prep, t);
+            graph.depend(t, finish);
+        }
+    }
+
+    // 4. 執行
+    size_t total_tasks = graph.size();
+    graph.run(num_threads, [&](size_t, size_t done) {
+        if (done % 16 == 0 || done == total_tasks) {
+            cout << "\r Tasks: " << done << "/" << total_tasks << flush;
+        }
+    });
+    cout << endl;
+    double total_sec = duration_cast<milliseconds>(steady_clock::now() - t0).count() / 1000.0;
+
+    // 5. Summary
+    string sum_path = root + "/summary.txt";
+    ostringstream rep;
+    rep << "PACP ALL-PAIRS REPORT | L=" << L << "\n";
+    rep << "-------------------------------------------------------\n";
+    rep << left << setw(15) << "Weight(g0,g1)" << " | " << setw(12) << "RawPairs" << " | " << setw(12)
+        << "UniquePairs" << " | Time(s)\n";
+    rep << "-------------------------------------------------------\n";
+    size_t total_uniq = 0;
+    for (const auto& job : jobs) {
+        string w = "(" + to_string(job->g0) + "," + to_string(job->g1) + ")";
+        rep << left << setw(15) << w << " | " << setw(12) << job->raw << " | " << setw(12) << job->uniq << " | "
+            << fixed << setprecision(2) << job->seconds << "\n";
+        total_uniq += job->uniq;
+    }
+    rep << "-------------------------------------------------------\n";
+    rep << "Total Unique: " << total_uniq << "\n";
+    rep << "Total Time: " << fixed << setprecision(2) << total_sec << "s\n";
+
+    ofstream sum_out(sum_path);
+    sum_out << rep.str();
+    sum_out.close();
+    cout << rep.str();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: ./aps_sched <L> <max_rho> [cross|join]\n";
+        cerr << "       (reads results/L/L_weight.txt, runs every weight pair)\n";
+        return 1;
+    }
+    int L = atoi(argv[1]);
+    int max_rho = atoi(argv[2]);
+    bool use_join = !(argc >= 4 && string(argv[3]) == "cross");
+    if (L <= 1) {
+        cerr << "Error: aps_sched needs L >= 2\n";
+        return 1;
+    }
+    return (L <= 127) ? schedule<int8_t>(L, max_rho, use_join) : schedule<int16_t>(L, max_rho, use_join);
+}
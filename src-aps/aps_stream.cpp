@@ -0,0 +1,296 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <type_traits>
+#include <filesystem>
+#include <cstdlib>
+#include "aps_gen.h"
+#include "aps_pool.h"
+#include "aps_match_core.h"
+#include "aps_canon.h"
+#include "aps_queue.h"
+#include "aps_parallel.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+/* =========================
+   Fused Streaming Pipeline
+   =========================
+   ./aps_stream L g0 g1 max_rho
+   DFS -> Match -> Filter 串在同一個程序裡，中間不落地成文字檔:
+
+     [DFS workers] --cand queue--> [matcher] --match queue--> [dedup]
+
+   - DFS workers: 依前綴搶任務 (g0 / g1 的前綴交錯排列，兩池一起長大)，
+     每個葉節點算好半譜 ACF 後直接推進佇列
+   - matcher: 增量版的補值雜湊連接。新候選先進自己那一池的雜湊表，
+     再探測另一池 (g0 == g1 時就是同一池，含自己)；每一對由「較晚到的那條」找到，恰好一次
+   - dedup: canonical pair 進 hash set，新的等價類立刻印出 (不必等 DFS 結束)
+   兩個佇列都是固定容量的 BoundedQueue，下游慢時上游自動等待。
+   [注意] 有界的只有佇列: matcher 的兩池 (bits / rows / table) 必須保留每一條候選才能讓
+   後到的候選探測，dedup 的 classes 也保留每個等價類，沒有 spill。
+   記憶體 ~ 候選數 x (序列 + stride 個 ACF + 雜湊節點)，隨池大小線性成長；
+   池放不進 RAM 時改用 aps_dfs (out-of-core 池) + aps_match + aps_filter (external sort)。
+   結束時把所有等價類排序寫成 unique_result.txt，內容與 aps_dfs + aps_match join + aps_filter 相同。
+   只支援 join 模式 (Goal 1 / Goal 2 的精確解)。
+   序列表示由 Traits 決定: L <= 64 走 uint64 + 定長 int8 ACF (不配置記憶體)，
+   L > 64 改用文字 + int16 ACF，canonical 用 canonical_string (與 aps_filter 的 L > 64 路徑相同)。
+*/
+
+const int MAX_H = ApsPool::MAX_L / 2;
+const size_t CAND_QUEUE = 1 << 14;
+const size_t MATCH_QUEUE = 1 << 12;
+
+struct PairKeyHash {
+    size_t operator()(const PairKey& k) const { return (size_t)(k.first * 0x9E3779B97F4A7C15ULL ^ k.second); }
+};
+
+struct PackedTraits {
+    typedef uint64_t Seq;                        // ApsPool::pack (bit i = s[i] 為 -1)
+    typedef int8_t AcfT;
+    typedef array<AcfT, MAX_H> Row;
+    typedef PairKey Key;
+    typedef PairKeyHash Hash;
+    static void init_row(Row&, int) {}
+    static Seq make(const vector<int>& s) { return ApsPool::pack(s); }
+    static Key key(const Seq& a, const Seq& b, int L) {
+        return canonical_pair(get_canonical(reverse_bits(a, L), L), get_canonical(reverse_bits(b, L), L));
+    }
+    static string line(const Key& k, int L) { return unpack_seq(k.first, L) + "," + unpack_seq(k.second, L); }
+};
+
+struct TextTraits {
+    typedef string Seq;                          // '+'/'-' 文字
+    typedef int16_t AcfT;
+    typedef vector<AcfT> Row;
+    typedef string Key;                          // canonical_pair_string
+    typedef hash<string> Hash;
+    static void init_row(Row& r, int H) { r.assign(H, 0); }
+    static Seq make(const vector<int>& s) { return ApsPool::text(s); }
+    static Key key(const Seq& a, const Seq& b, int L) {
+        return canonical_pair_string(canonical_string(a.data(), L), canonical_string(b.data(), L));
+    }
+    static string line(const Key& k, int) { return k; }
+};
+
+template <typename Traits>
+struct Cand {
+    typename Traits::Seq bits;
+    int side;                // 0: g0, 1: g1
+    typename Traits::Row acf;                    // rho(1..L/2)
+};
+
+template <typename Traits>
+struct Match {
+    typename Traits::Seq a, b;
+};
+
+// 一池: 依到達順序存放的 ACF 列 + 前 K 個 lag 的雜湊表
+template <typename Traits>
+struct StreamPool {
+    vector<typename Traits::Seq> bits;
+    vector<typename Traits::AcfT> rows;          // 每列 stride 個，補零
+    unordered_multimap<uint64_t, uint32_t> table;
+};
+
+template <typename Traits>
+int stream(int L, int g0, int g1, int max_rho) {
+    typedef typename Traits::AcfT AcfT;
+    typedef Cand<Traits> CandT;
+    typedef Match<Traits> MatchT;
+    typedef StreamPool<Traits> Pool;
+
+    const int H = L / 2;
+    const bool odd = (L % 2 != 0);
+    const int target_sum = odd ? 2 : 4;
+    const int K = odd ? min(H, JOIN_MAX_KEY_LAGS) : H - 1;
+    const uint32_t num_probes = odd ? (1u << K) : 1u;
+    const int stride = (H + BLOCK - 1) / BLOCK * BLOCK;
+    const bool same = (g0 == g1);
+    int num_threads = aps_thread_count();
+
+    string dir = "results/" + to_string(L) + "/" + to_string(g0) + "_" + to_string(g1);
+    error_code ec;
+    fs::create_directories(dir, ec);
+
+    cout << "-------------------------------------------" << endl;
+    cout << " APS Stream | L=" << L << " | Weight: " << g0 << "," << g1 << " | MAX_RHO=" << max_rho
+         << " | DFS threads: " << num_threads << endl;
+
+    auto t0 = steady_clock::now();
+
+    // 1. Generators + 交錯的前綴任務
+    vector<unique_ptr<ApsGen::Generator>> gens;
+    vector<int> depth;
+    vector<vector<ApsGen::Prefix>> prefixes;
+    for (int g : { g0, g1 }) {
+        ApsGen::Config cfg;
+        cfg.L = L;
+        cfg.g = g;
+        cfg.max_rho = max_rho;
+        gens.emplace_back(new ApsGen::Generator(cfg));
+        depth.push_back(gens.back()->split_depth(num_threads));
+        prefixes.push_back(gens.back()->split(depth.back()));
+        if (same) break;
+    }
+    vector<pair<int, size_t>> tasks;   // (side, prefix)
+    for (size_t i = 0; i < max(prefixes[0].size(), same ? 0 : prefixes[1].size()); i++) {
+        for (int side = 0; side < (int)prefixes.size(); side++) {
+            if (i < prefixes[side].size()) tasks.push_back({ side, i });
+        }
+    }
+
+    BoundedQueue<CandT> cand_q(CAND_QUEUE);
+    BoundedQueue<MatchT> match_q(MATCH_QUEUE);
+    atomic<size_t> next_task(0);
+    atomic<int> live_producers(num_threads);
+    atomic<long long> generated[2] = { {0}, {0} };
+
+    auto producer = [&](int) {
+        vector<ApsGen::Generator::State> states;
+        for (auto& g : gens) states.emplace_back(*g);
+        CandT c;
+        Traits::init_row(c.acf, H);
+        for (size_t t = next_task++; t < tasks.size(); t = next_task++) {
+            int side = tasks[t].first;
+            c.side = side;
+            auto on_leaf = [&](ApsGen::Generator::State& cur) {
+                const vector<int>& s = cur.s;
+                c.bits = Traits::make(s);
+                for (int u = 1; u <= H; u++) {
+                    int sum = 0;
+                    for (int i = 0; i < L; i++) sum += s[i] * s[(i + u < L) ? i + u : i + u - L];
+                    c.acf[u - 1] = (AcfT)sum;
+                }
+                cand_q.push(c);
+                generated[side]++;
+            };
+            gens[side]->run_prefix(states[side], prefixes[side][tasks[t].second], depth[side], on_leaf);
+        }
+        if (--live_producers == 0) cand_q.close();
+    };
+
+    // 2. Matcher: 增量雜湊連接
+    long long raw_matches = 0;
+    size_t pool_bytes = 0;             // 結束時兩池的大約大小 (報告用)
+    auto matcher = [&]() {
+        Pool pools[2];
+        vector<int> key(max(K, 1)), probe(max(K, 1));
+        vector<uint32_t> hits;
+        CandT c;
+        while (cand_q.pop(c)) {
+            Pool& own = pools[same ? 0 : c.side];
+            Pool& other = pools[same ? 0 : 1 - c.side];
+
+            uint32_t id = (uint32_t)own.bits.size();
+            own.bits.push_back(c.bits);
+            own.rows.resize(own.rows.size() + stride, 0);
+            AcfT* row = &own.rows[(size_t)id * stride];
+            copy(c.acf.begin(), c.acf.begin() + H, row);
+            for (int u = 0; u < K; u++) key[u] = row[u];
+            own.table.insert({ key_hash(key.data(), K), id });
+
+            hits.clear();
+            for (uint32_t m = 0; m < num_probes; m++) {
+                for (int u = 0; u < K; u++) {
+                    probe[u] = -(int)row[u];
+                    if (odd) probe[u] += ((m >> u) & 1u) ? 2 : -2;
+                }
+                auto range = other.table.equal_range(key_hash(probe.data(), K));
+                for (auto it = range.first; it != range.second; ++it) {
+                    const AcfT* rb = &other.rows[(size_t)it->second * stride];
+                    bool ok = odd ? pair_ok(row, rb, stride, target_sum) : goal2_ok(row, rb, H);
+                    if (ok) hits.push_back(it->second);
+                }
+            }
+            sort(hits.begin(), hits.end());
+            hits.erase(unique(hits.begin(), hits.end()), hits.end());
+            for (uint32_t j : hits) {
+                match_q.push({ c.bits, other.bits[j] });
+                raw_matches++;
+            }
+        }
+        for (const Pool& p : pools) {
+            pool_bytes += p.bits.size() * sizeof(typename Traits::Seq) + p.rows.size() * sizeof(AcfT) +
+                          p.table.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*));
+            if (is_same<typename Traits::Seq, string>::value) pool_bytes += p.bits.size() * L;
+        }
+        match_q.close();
+    };
+
+    // 3. Dedup: canonical pair，新的等價類立刻輸出
+    typedef typename Traits::Key Key;
+    unordered_set<Key, typename Traits::Hash> classes;
+    double first_sec = -1;
+    auto dedup = [&]() {
+        MatchT m;
+        while (match_q.pop(m)) {
+            Key k = Traits::key(m.a, m.b, L);
+            if (classes.insert(k).second) {
+                if (first_sec < 0) first_sec = duration_cast<milliseconds>(steady_clock::now() - t0).count() / 1000.0;
+                cout << "UNIQUE: " << Traits::line(k, L) << endl;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int t = 0; t < num_threads; t++) threads.emplace_back(producer, t);
+    thread match_thread(matcher);
+    thread dedup_thread(dedup);
+    for (auto& th : threads) th.join();
+    match_thread.join();
+    dedup_thread.join();
+
+    // 4. 排序後輸出 (與 aps_filter 相同的順序)
+    vector<Key> keys(classes.begin(), classes.end());
+    sort(keys.begin(), keys.end());
+    string out_path = dir + "/unique_result.txt";
+    if (raw_matches > 0) {
+        ofstream out(out_path);
+        for (const auto& k : keys) out << Traits::line(k, L) << "\n";
+    }
+
+    double total_sec = duration_cast<milliseconds>(steady_clock::now() - t0).count() / 1000.0;
+    cout << "-------------------------------------------" << endl;
+    cout << " Stream Report:" << endl;
+    cout << " - Candidates: g" << g0 << "=" << generated[0].load();
+    if (!same) cout << ", g" << g1 << "=" << generated[1].load();
+    cout << endl;
+    cout << " - Raw pairs matched: " << raw_matches << endl;
+    cout << " - Pool memory (approx): " << pool_bytes / (1 << 20) << " MiB (grows with pool size, no spill)" << endl;
+    cout << " - Unique classes found: " << keys.size() << endl;
+    if (first_sec >= 0) cout << " - Time to first result: " << first_sec << " s" << endl;
+    cout << " - Time elapsed: " << total_sec << " s" << endl;
+    if (raw_matches > 0) cout << " - Saved to: " << out_path << endl;
+    cout << "-------------------------------------------" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        cerr << "Usage: ./aps_stream <L> <g0> <g1> <max_rho>\n";
+        cerr << "       (every candidate and class stays in RAM; memory grows with pool size.\n";
+        cerr << "        use aps_dfs + aps_match + aps_filter for pools that do not fit)\n";
+        return 1;
+    }
+    int L = atoi(argv[1]);
+    int g0 = atoi(argv[2]);
+    int g1 = atoi(argv[3]);
+    int max_rho = atoi(argv[4]);
+    if (L <= 1) {
+        cerr << "Error: aps_stream needs L >= 2\n";
+        return 1;
+    }
+    if (L <= ApsPool::MAX_L) return stream<PackedTraits>(L, g0, g1, max_rho);
+    return stream<TextTraits>(L, g0, g1, max_rho);
+}
@@ -1,4 +1,7 @@
 #include "../lib/pacp_core.h"
+#include "../lib/pacp_bitslice.h"
+#include "../lib/pacp_enum.h"
+#include "../lib/pacp_census.h"
 #include <iostream>
 #include <vector>
 #include <set>
@@ -7,13 +10,30 @@
 
 int main(int argc, char* argv[]) {
     if (argc < 3) {
-        std::cerr << "Usage: ./brute_force <OutFile> <L>" << std::endl;
+        std::cerr << "Usage: ./brute_force <OutFile> <L> [bitslice|scalar] [weight|full]" << std::endl;
+        std::cerr << "       ./brute_force <OutFile> <L> census [MaxSamples]" << std::endl;
         return 1;
     }
 
     std::string out_file = argv[1];
     int L = std::stoi(argv[2]);
 
+    // census: 只計數 Goal 1/2/3 的等價類 (不保存解)，記憶體與解的數量無關
+    if (argc >= 4 && std::string(argv[3]) == "census") {
+        if (L < 2 || L > Census::MAX_L) {
+            std::cerr << "[Error] Census supports 2 <= L <= " << Census::MAX_L << std::endl;
+            return 1;
+        }
+        long long max_samples = (argc >= 5) ? std::stoll(argv[4]) : 0;
+        Census::run(L, out_file, max_samples);
+        return 0;
+    }
+
+    std::string backend = (argc >= 4) ? argv[3] : "bitslice";
+    bool use_bitslice = (backend != "scalar") && (L <= BitSlice::MAX_L);
+    // weight: 只列舉能量恆等式允許的 Hamming weight；full: 全部 2^L (參考用)
+    bool weight_mode = !(argc >= 5 && std::string(argv[4]) == "full");
+
     if (L > 18) { // L=18 已經非常極限，建議 L<=14
         std::cerr << "[Warning] L=" << L << " might be too slow for Brute Force." << std::endl;
     }
@@ -23,7 +43,8 @@ int main(int argc, char* argv[]) {
     int min_psl = 999999; 
     
     std::vector<std::pair<Seq, Seq>> best_solutions;
-    std::set<std::pair<std::string, std::string>> seen_canonical;
+    // [優化] 以整數化的 canonical key 去重 (等價類與 get_canonical_repr 相同)
+    std::set<std::pair<uint64_t, uint64_t>> seen_canonical;
 
     Seq A(L), B(L);
     std::vector<int> acf_A(L), acf_B(L);
@@ -32,78 +53,194 @@ int main(int argc, char* argv[]) {
     long long current_op = 0;
     
     std::cout << "--------------------------------------------------\n";
-    std::cout << " BRUTE FORCE (OPTIMIZED) | L=" << L << "\n";
+    std::cout << " BRUTE FORCE (OPTIMIZED) | L=" << L << " | Backend=" << (use_bitslice ? "bitslice" : "scalar")
+              << " | Enum=" << (weight_mode ? "weight" : "full") << "\n";
     std::cout << "--------------------------------------------------\n";
 
-    // 外層迴圈: 遍歷 A
-    for (long long i = 0; i < limit; ++i) {
-        
-        // [優化 1] 對稱性剪枝: 固定 A 的第一個元素為 +1 (即 bit 0 為 0)
-        // 若 (i & 1) != 0，表示 A[0] 是 -1，跳過
-        // int_to_seq 的實作是: bit 0 -> s[0]。若 bit=1 則 s=-1。
-        if ((i & 1) != 0) continue; 
+    uint64_t key_A = 0;
 
-        int_to_seq(i, L, A);
-        compute_acf(A, acf_A);
+    // 單一候選 B 的完整評估 (scalar 路徑，bitslice 的存活者也走這裡)
+    auto evaluate_candidate = [&](long long j) {
+        int_to_seq(j, L, B);
+        
+        // [優化 2] 提早離開 (Early Exit)
+        // 我們不一次算完 ACF_B，而是邊算邊檢查 PSL
+        int current_max_sidelobe = 0;
 
-        // 內層迴圈: 遍歷 B
-        for (long long j = 0; j < limit; ++j) {
-            current_op++;
+        // 計算 acf_B 並檢查
+        // 注意: 這裡手動展開 compute_acf + calc_psl 以達成提早離開
+        // 週期 ACF 對稱 (rho(u) = rho(L-u))，只需檢查 u <= L/2
+        for (int u = 1; u <= L / 2; ++u) {
+            int sum_b = 0;
+            int k_wrap = L - u;
+            for (int k = 0; k < k_wrap; ++k) sum_b += B[k] * B[k + u];
+            for (int k = k_wrap; k < L; ++k) sum_b += B[k] * B[k - k_wrap];
             
-            // 進度條 (每 1M 次更新一次，避免 I/O 拖慢)
-            if ((current_op & 0xFFFFF) == 0) {
-                 std::cout << "\r[Scanning] " << std::fixed << std::setprecision(1) 
-                           << (double)current_op/total_ops*100.0 << "% | Best PSL: " << min_psl << "   " << std::flush;
+            // 立即檢查 PSL
+            int val = std::abs(acf_A[u] + sum_b);
+            if (val > min_psl) return; // [關鍵] 只要有一個 u 爆掉，後面都不用算了
+            if (val > current_max_sidelobe) {
+                current_max_sidelobe = val;
             }
+        }
 
-            int_to_seq(j, L, B);
-            
-            // [優化 2] 提早離開 (Early Exit)
-            // 我們不一次算完 ACF_B，而是邊算邊檢查 PSL
-            int current_max_sidelobe = 0;
-            bool possible_candidate = true;
-
-            // 計算 acf_B 並檢查
-            // 注意: 這裡手動展開 compute_acf + calc_psl 以達成提早離開
-            for (int u = 1; u < L; ++u) {
-                int sum_b = 0;
-                for (int k = 0; k < L; ++k) {
-                    sum_b += B[k] * B[(k + u) % L];
-                }
-                
-                // 立即檢查 PSL
-                int val = std::abs(acf_A[u] + sum_b);
-                if (val > min_psl) {
-                    possible_candidate = false;
-                    break; // [關鍵] 只要有一個 u 爆掉，後面都不用算了
+        // 如果活下來了，表示 current_max_sidelobe <= min_psl
+        int psl = current_max_sidelobe;
+
+        // 處理更佳解
+        if (psl < min_psl) {
+            min_psl = psl;
+            best_solutions.clear();
+            seen_canonical.clear();
+            std::cout << "\r[Update] New Best PSL: " << min_psl << " found.            " << std::flush;
+        }
+
+        // 處理同級解 (唯一化)
+        if (psl == min_psl) {
+            uint64_t cb = BitSlice::canonical_key((uint64_t)j, L);
+            uint64_t ca = key_A;
+            if (ca > cb) std::swap(ca, cb);
+
+            if (seen_canonical.find({ca, cb}) == seen_canonical.end()) {
+                seen_canonical.insert({ca, cb});
+                best_solutions.push_back({A, B});
+            }
+        }
+    };
+
+    auto report_progress = [&]() {
+        std::cout << "\r[Scanning] " << std::fixed << std::setprecision(1) 
+                  << (double)current_op/total_ops*100.0 << "% | Best PSL: " << min_psl << "   " << std::flush;
+    };
+
+    uint64_t planes[BitSlice::MAX_L];
+
+    // [優化 4] 權重限制: B 只評估能量恆等式允許的 Hamming weight
+    //   scalar  : 以 Gosper (組合數系統順序) 逐類別列舉
+    //   bitslice: 仍以連續 64 個為一批 (低 6 bit = lane)，不允許權重的 lane 直接遮掉，
+    //             整批都不允許就跳過，不需要任何轉置
+    auto scan_B_weighted = [&](int sum_A) {
+        bool allowed[BitSlice::MAX_L + 1];
+        int allowed_psl = -1;
+        auto refresh_allowed = [&]() {
+            bool any = false;
+            for (int w = 0; w <= L; ++w) {
+                allowed[w] = WeightEnum::energy_admissible(sum_A, WeightEnum::sum_of_weight(L, w), L, min_psl);
+                any = any || allowed[w];
+            }
+            allowed_psl = min_psl;
+            return any;
+        };
+        if (!refresh_allowed()) return;
+
+        if (!use_bitslice) {
+            for (int wB = 0; wB <= L; ++wB) {
+                if (!allowed[wB]) continue;
+                for (uint64_t j = WeightEnum::first_of_weight(wB); j < (uint64_t)limit; j = WeightEnum::next_same_weight(j)) {
+                    evaluate_candidate((long long)j);
                 }
-                if (val > current_max_sidelobe) {
-                    current_max_sidelobe = val;
+            }
+            return;
+        }
+
+        int low_bits = std::min(L, 6);
+        for (long long base = 0; base < limit; base += BitSlice::LANES) {
+            // min_psl 在掃描中會下降，允許的類別跟著收緊
+            if (min_psl != allowed_psl && !refresh_allowed()) return;
+
+            int w_high = __builtin_popcountll((uint64_t)base);
+            uint64_t valid = 0;
+            for (int wl = 0; wl <= low_bits && w_high + wl <= L; ++wl) {
+                if (allowed[w_high + wl]) valid |= BitSlice::lane_weight_mask(wl);
+            }
+            long long n = std::min<long long>(BitSlice::LANES, limit - base);
+            if (n < BitSlice::LANES) valid &= (1ULL << n) - 1;
+            if (!valid) continue;
+
+            BitSlice::load_consecutive((uint64_t)base, L, planes);
+            uint64_t alive = BitSlice::filter_periodic(planes, L, acf_A.data(), min_psl, valid);
+            while (alive) {
+                int t = __builtin_ctzll(alive);
+                alive &= alive - 1;
+                evaluate_candidate(base + t);
+            }
+        }
+    };
+
+    if (weight_mode) {
+        // A: bit 0 固定為 0 (A[0] = +1)，其餘 L-1 位依權重類別列舉
+        // 相鄰遮罩只差少數 bit，ACF 以 O(L) per bit 增量更新
+        total_ops = limit / 2;
+        long long tail_limit = limit / 2;
+
+        for (int wA : WeightEnum::weights_by_energy(L - 1, L)) {
+            int sum_A = WeightEnum::sum_of_weight(L, wA);
+
+            uint64_t tail = WeightEnum::first_of_weight(wA);
+            uint64_t i = tail << 1;
+            int_to_seq((int)i, L, A);
+            compute_periodic_acf(A, acf_A);
+
+            while (true) {
+                current_op++;
+                if ((current_op & 0x3FF) == 0) report_progress();
+
+                key_A = BitSlice::canonical_key(i, L);
+                scan_B_weighted(sum_A);
+
+                tail = WeightEnum::next_same_weight(tail);
+                if (tail >= (uint64_t)tail_limit) break;
+                uint64_t next_i = tail << 1;
+                for (uint64_t diff = i ^ next_i; diff; diff &= diff - 1) {
+                    flip_update_periodic_acf(A, acf_A, __builtin_ctzll(diff));
                 }
+                i = next_i;
             }
+        }
+    } else {
+        // 外層迴圈: 遍歷 A
+        for (long long i = 0; i < limit; ++i) {
+            
+            // [優化 1] 對稱性剪枝: 固定 A 的第一個元素為 +1 (即 bit 0 為 0)
+            // 若 (i & 1) != 0，表示 A[0] 是 -1，跳過
+            // int_to_seq 的實作是: bit 0 -> s[0]。若 bit=1 則 s=-1。
+            if ((i & 1) != 0) continue; 
 
-            if (!possible_candidate) continue;
+            int_to_seq(i, L, A);
+            // [Fix] A 也用週期 ACF (B 一直是週期的；PACP 的定義兩者都是週期)
+            compute_periodic_acf(A, acf_A);
+            key_A = BitSlice::canonical_key((uint64_t)i, L);
 
-            // 如果活下來了，表示 current_max_sidelobe <= min_psl
-            int psl = current_max_sidelobe;
+            if (!use_bitslice) {
+                // 內層迴圈: 遍歷 B
+                for (long long j = 0; j < limit; ++j) {
+                    current_op++;
+                    
+                    // 進度條 (每 1M 次更新一次，避免 I/O 拖慢)
+                    if ((current_op & 0xFFFFF) == 0) report_progress();
 
-            // 處理更佳解
-            if (psl < min_psl) {
-                min_psl = psl;
-                best_solutions.clear();
-                seen_canonical.clear();
-                std::cout << "\r[Update] New Best PSL: " << min_psl << " found.            " << std::flush;
+                    evaluate_candidate(j);
+                }
+                continue;
             }
 
-            // 處理同級解 (唯一化)
-            if (psl == min_psl) {
-                std::string ca = get_canonical_repr(A);
-                std::string cb = get_canonical_repr(B);
-                if (ca > cb) std::swap(ca, cb);
+            // [優化 3] Bit-sliced: 一次 64 個 B，先以遮罩淘汰，存活者才逐一精算
+            for (long long base = 0; base < limit; base += BitSlice::LANES) {
+                long long n = std::min<long long>(BitSlice::LANES, limit - base);
+                uint64_t valid = (n == BitSlice::LANES) ? ~0ULL : ((1ULL << n) - 1);
+                
+                long long prev_op = current_op;
+                current_op += n;
+                if ((prev_op >> 20) != (current_op >> 20)) report_progress();
+
+                BitSlice::load_consecutive((uint64_t)base, L, planes);
+                uint64_t alive = BitSlice::filter_periodic(planes, L, acf_A.data(), min_psl, valid);
 
-                if (seen_canonical.find({ca, cb}) == seen_canonical.end()) {
-                    seen_canonical.insert({ca, cb});
-                    best_solutions.push_back({A, B});
+                // 依 lane 順序處理，與 scalar 路徑的順序 (及結果) 完全一致
+                while (alive) {
+                    int t = __builtin_ctzll(alive);
+                    alive &= alive - 1;
+                    evaluate_candidate(base + t);
                 }
             }
         }
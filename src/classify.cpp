@@ -0,0 +1,349 @@
+#include "../lib/pacp_results.h"
+#include "../lib/pacp_verify.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <regex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
+#include <filesystem>
+#include <cstdio>
+#include <ctime>
+
+namespace fs = std::filesystem;
+
+// ==========================================
+// classify: 一次驗證 + 分類所有整合結果 (取代 optimal1/2/3.sh、szcp 與 summary.sh 的掃描)
+// ==========================================
+// 每筆 (A, B) 只算一次週期 ACF (lib/pacp_verify.h，packed XOR + popcount，任意 L)，
+// 在執行緒池上平行計算，然後同時判定所有類別；每個類別都是實際驗證過的，不再相信行內的 Max= / Peaks=。
+// Usage:
+//   ./bin/classify [--src DIR] [--out DIR] [--report FILE] [--threads N] [--zcz-min Z]
+//                  [--only odd|even|pqcp|near|szcp]... [--no-report] [--report-only]
+//     輸入: <src>/L<L>_T1_merged.txt、L<L>_T2_merged.txt (或 .pacpr)，同一等價類只輸出一次
+//     輸出 (<out> 預設 ./results-final):
+//       Goal1_Odd/L<L>_Goal1.txt       奇數 optimal (所有 |S| == 2)
+//       Goal2_Even/L<L>_Goal2.txt      偶數 optimal (ZCZ 完整，|S(L/2)| == 4)
+//       Goal3_PQCP/L<L>_Goal3.txt      PQCP (|S| <= 4，peaks == 2)
+//       Near/L<L>_Near.txt             near-optimal
+//       SZCP/L<L>_Z<Z>_SZCP.txt        零相關區寬度 Z >= --zcz-min (預設 L/2)
+//     報表: final_report.txt (格式同原本的 summary.sh)
+
+struct ClassDef {
+    uint32_t bit;
+    const char* key;      // --only 用
+    const char* folder;
+    const char* suffix;   // 檔名 L<L>_<suffix>.txt
+    const char* label;    // 終端機訊息
+    const char* title;    // 報表標題
+};
+
+static const ClassDef CLASSES[] = {
+    { Verify::ODD_OPT, "odd", "Goal1_Odd", "Goal1", "Goal 1", "Goal 1 (Odd Optimal)" },
+    { Verify::EVEN_OPT, "even", "Goal2_Even", "Goal2", "Goal 2", "Goal 2 (Even Optimal)" },
+    { Verify::PQCP, "pqcp", "Goal3_PQCP", "Goal3", "Goal 3", "Goal 3 (PQCP Specific)" },
+    { Verify::NEAR, "near", "Near", "Near", "Near", "Near Optimal" },
+    { Verify::SZCP, "szcp", "SZCP", "SZCP", "SZCP", "SZCP (ZCZ >= Z)" },
+};
+
+// 一筆待分類的 pair: 文字行 (text) 或二進位 record (bin)
+struct Item {
+    const char* text = nullptr;
+    uint32_t len = 0;
+    const PacpResults::RecordView* bin = nullptr;
+    uint64_t fp = 0;
+    uint32_t classes = 0;
+    int zcz = 0;
+};
+
+struct LengthInput {
+    std::vector<std::string> files;
+};
+
+// 同一個 L 的所有來源 (mmap 保持開啟直到輸出完成)
+struct LengthBatch {
+    std::vector<std::unique_ptr<MappedFile>> texts;
+    std::vector<std::unique_ptr<PacpResults::Reader>> bins;
+    std::vector<PacpResults::RecordView> views;
+    std::vector<Item> items;
+};
+
+static void collect(int L, const LengthInput& in, LengthBatch& batch) {
+    // 先收 views，避免 push_back 過程中 Item 指向的位址失效
+    for (const std::string& path : in.files) {
+        if (PacpResults::is_binary_file(path)) {
+            auto rd = std::make_unique<PacpResults::Reader>();
+            if (!rd->open(path)) continue;
+            rd->for_each([&](const PacpResults::RecordView& v) {
+                if (v.h->L == L) batch.views.push_back(v);
+            });
+            batch.bins.push_back(std::move(rd));
+            continue;
+        }
+        auto m = std::make_unique<MappedFile>();
+        if (!m->open(path) || m->size() == 0) continue;
+        PacpParse::LineScanner lines(m->data(), m->data() + m->size());
+        const char* p;
+        const char* t;
+        while (lines.next(p, t)) {
+            if (*p == '#') continue;
+            Item it;
+            it.text = p;
+            it.len = (uint32_t)(t - p);
+            batch.items.push_back(it);
+        }
+        batch.texts.push_back(std::move(m));
+    }
+    for (const auto& v : batch.views) {
+        Item it;
+        it.bin = &v;
+        batch.items.push_back(it);
+    }
+}
+
+// 平行計算每筆的 ACF 與類別；不符長度 / 壞行的 classes 為 0
+static void classify_all(int L, std::vector<Item>& items, int num_threads, int zcz_min) {
+    std::atomic<size_t> next(0);
+    const size_t BLOCK = 64;
+    auto worker = [&]() {
+        Verify::Kernel kernel;
+        PacpResults::TextRecord r;
+        std::vector<uint64_t> a(PacpResults::words_for(L)), b(PacpResults::words_for(L));
+        for (size_t s = next.fetch_add(BLOCK); s < items.size(); s = next.fetch_add(BLOCK)) {
+            size_t e = std::min(items.size(), s + BLOCK);
+            for (size_t i = s; i < e; ++i) {
+                Item& it = items[i];
+                const uint64_t* pa;
+                const uint64_t* pb;
+                if (it.bin) {
+                    pa = it.bin->a;
+                    pb = it.bin->b;
+                    it.fp = it.bin->h->fingerprint;
+                } else {
+                    // 標頭 (L=..,PSL=..,Count=..) 與其他長度的行直接略過
+                    if (!PacpResults::parse_text(it.text, it.text + it.len, r) || r.h.L != L) continue;
+                    PacpParse::pack_pm(r.a, L, a.data());
+                    PacpParse::pack_pm(r.b, L, b.data());
+                    pa = a.data();
+                    pb = b.data();
+                    it.fp = r.h.fingerprint;
+                }
+                Verify::Profile p = kernel.classify(pa, pb, L, zcz_min);
+                it.classes = p.classes;
+                it.zcz = p.zcz;
+            }
+        }
+    };
+    num_threads = std::max(1, std::min<int>(num_threads, (int)((items.size() + BLOCK - 1) / BLOCK)));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker);
+    for (auto& th : threads) th.join();
+}
+
+static std::string class_file(const std::string& out_dir, const ClassDef& c, int L, int zcz) {
+    std::string name = "L" + std::to_string(L) + "_";
+    if (c.bit == Verify::SZCP) name += "Z" + std::to_string(zcz) + "_";
+    return out_dir + "/" + c.folder + "/" + name + c.suffix + ".txt";
+}
+
+// 此 L 舊的分類結果先刪掉，沒有結果的類別就不留空檔
+static void remove_old(const std::string& out_dir, const ClassDef& c, int L) {
+    std::error_code ec;
+    std::string dir = out_dir + "/" + c.folder;
+    std::regex re("L" + std::to_string(L) + "_(Z[0-9]+_)?" + c.suffix + "\\.txt");
+    for (auto it = fs::directory_iterator(dir, ec); it != fs::directory_iterator(); it.increment(ec)) {
+        if (ec) break;
+        if (std::regex_match(it->path().filename().string(), re)) fs::remove(it->path(), ec);
+    }
+}
+
+// 依類別寫出 (保持輸入順序，同一等價類只寫第一次出現的那行)；回傳 {class bit / Z -> 筆數}
+static std::map<std::string, long long> write_classes(int L, const std::vector<Item>& items, const std::string& out_dir,
+                                                      uint32_t enabled) {
+    std::map<std::string, long long> counts;
+    std::string line;
+    for (const ClassDef& c : CLASSES) {
+        if (!(enabled & c.bit)) continue;
+        remove_old(out_dir, c, L);
+        std::map<int, std::string> bufs;   // SZCP 依 Z 分檔，其他類別只有 key 0
+        std::unordered_set<uint64_t> seen;
+        for (const Item& it : items) {
+            if (!(it.classes & c.bit) || !seen.insert(it.fp).second) continue;
+            std::string& buf = bufs[c.bit == Verify::SZCP ? it.zcz : 0];
+            if (it.bin) {
+                PacpResults::format_line(*it.bin->h, it.bin->a, it.bin->b, line);
+                buf += line;
+            } else {
+                buf.append(it.text, it.len);
+            }
+            buf += '\n';
+        }
+        for (const auto& kv : bufs) {
+            std::string path = class_file(out_dir, c, L, kv.first);
+            std::error_code ec;
+            fs::create_directories(fs::path(path).parent_path(), ec);
+            std::FILE* f = std::fopen(path.c_str(), "wb");
+            if (!f) {
+                std::cerr << "[Error] Cannot write " << path << "\n";
+                continue;
+            }
+            std::fwrite(kv.second.data(), 1, kv.second.size(), f);
+            std::fclose(f);
+            long long n = (long long)std::count(kv.second.begin(), kv.second.end(), '\n');
+            std::string label = c.label;
+            if (c.bit == Verify::SZCP) label += " Z=" + std::to_string(kv.first);
+            counts[label] = n;
+            std::cout << "   [" << label << "] L=" << L << ": 存入 " << n << " 筆\n";
+        }
+    }
+    return counts;
+}
+
+/* =========================
+   Report (同原本的 summary.sh)
+   ========================= */
+static long long count_lines(const std::string& path) {
+    MappedFile m;
+    if (!m.open(path) || m.size() == 0) return 0;
+    long long n = 0;
+    const char* p = m.data();
+    const char* end = p + m.size();
+    while ((p = (const char*)std::memchr(p, '\n', end - p)) != nullptr) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+static int length_of(const std::string& name) {
+    std::smatch m;
+    static const std::regex re("L([0-9]+)");
+    return std::regex_search(name, m, re) ? std::stoi(m[1].str()) : 0;
+}
+
+static void write_report(const std::string& out_dir, const std::string& report_path) {
+    std::FILE* f = std::fopen(report_path.c_str(), "w");
+    if (!f) {
+        std::cerr << "[Error] Cannot write " << report_path << "\n";
+        return;
+    }
+    char ts[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    std::fprintf(f, "========================================================\n");
+    std::fprintf(f, "               PACP 搜尋結果統計總表                    \n");
+    std::fprintf(f, "      時間: %s              \n", ts);
+    std::fprintf(f, "========================================================\n");
+
+    std::error_code ec;
+    for (const ClassDef& c : CLASSES) {
+        std::string dir = out_dir + "/" + c.folder;
+        std::fprintf(f, "\n[%s]\n", c.title);
+        std::fprintf(f, "%-8s | %-8s | %s\n", "Length", "Count", "Filename");
+        std::fprintf(f, "---------|----------|---------------------------------\n");
+        if (!fs::is_directory(dir, ec)) {
+            std::fprintf(f, "  (目錄未建立)\n");
+            continue;
+        }
+        std::vector<std::string> names;
+        for (auto it = fs::recursive_directory_iterator(dir, ec); it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (ec) break;
+            if (it->is_regular_file(ec) && it->path().extension() == ".txt") names.push_back(it->path().string());
+        }
+        // sort -V: 依 L 排，再依檔名
+        std::sort(names.begin(), names.end(), [](const std::string& x, const std::string& y) {
+            int lx = length_of(fs::path(x).filename().string()), ly = length_of(fs::path(y).filename().string());
+            return lx != ly ? lx < ly : x < y;
+        });
+        if (names.empty()) std::fprintf(f, "  (無資料)\n");
+        for (const std::string& p : names) {
+            std::string fname = fs::path(p).filename().string();
+            std::fprintf(f, "%-8d | %-8lld | %s\n", length_of(fname), count_lines(p), fname.c_str());
+        }
+    }
+
+    long long total = 0;
+    if (fs::is_directory(out_dir, ec)) {
+        for (auto it = fs::recursive_directory_iterator(out_dir, ec); it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (ec) break;
+            std::string p = it->path().string();
+            if (it->is_regular_file(ec) && it->path().extension() == ".txt" && p.find("report") == std::string::npos) total++;
+        }
+    }
+    std::fprintf(f, "\n========================================================\n");
+    std::fprintf(f, "總檔案數: %lld\n", total);
+    std::fclose(f);
+    std::cout << "報表生成完畢: " << report_path << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string src_dir = "./results-g";
+    std::string out_dir = "./results-final";
+    std::string report_path = "final_report.txt";
+    int num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int zcz_min = 0;   // 0: 每個 L 用 L/2
+    uint32_t enabled = 0;
+    bool report = true, report_only = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--src" && i + 1 < argc) src_dir = argv[++i];
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (a == "--report" && i + 1 < argc) report_path = argv[++i];
+        else if (a == "--threads" && i + 1 < argc) num_threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--zcz-min" && i + 1 < argc) zcz_min = std::max(2, std::atoi(argv[++i]));
+        else if (a == "--no-report") report = false;
+        else if (a == "--report-only") report_only = true;
+        else if (a == "--only" && i + 1 < argc) {
+            std::string key = argv[++i];
+            uint32_t bit = 0;
+            for (const ClassDef& c : CLASSES) if (key == c.key) bit = c.bit;
+            if (!bit) { std::cerr << "[Error] Unknown class: " << key << "\n"; return 1; }
+            enabled |= bit;
+        }
+        else { std::cerr << "[Error] Unknown option: " << a << "\n"; return 1; }
+    }
+    if (enabled == 0) for (const ClassDef& c : CLASSES) enabled |= c.bit;
+
+    if (report_only) {
+        write_report(out_dir, report_path);
+        return 0;
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(src_dir, ec)) {
+        std::cerr << "[Error] Source directory not found: " << src_dir << "\n";
+        return 1;
+    }
+    std::map<int, LengthInput> by_length;
+    std::regex pattern(R"(L([0-9]+)_T[12]_merged\.(txt|pacpr))");
+    for (auto it = fs::directory_iterator(src_dir, ec); it != fs::directory_iterator(); it.increment(ec)) {
+        if (ec) break;
+        std::smatch m;
+        std::string name = it->path().filename().string();
+        if (it->is_regular_file(ec) && std::regex_match(name, m, pattern))
+            by_length[std::stoi(m[1].str())].files.push_back(it->path().string());
+    }
+
+    std::cout << "啟動結果驗證與分類 (" << num_threads << " threads) -> 輸出目錄: " << out_dir << "\n";
+    auto t0 = std::chrono::steady_clock::now();
+    long long total = 0;
+    for (auto& kv : by_length) {
+        int L = kv.first;
+        std::sort(kv.second.files.begin(), kv.second.files.end());   // T1 在 T2 前
+        LengthBatch batch;
+        collect(L, kv.second, batch);
+        classify_all(L, batch.items, num_threads, zcz_min > 0 ? zcz_min : std::max(2, L / 2));
+        write_classes(L, batch.items, out_dir, enabled);
+        total += (long long)batch.items.size();
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "✅ 分類完畢。(" << by_length.size() << " lengths, " << total << " lines, " << sec << " s)\n";
+
+    if (report) write_report(out_dir, report_path);
+    return 0;
+}
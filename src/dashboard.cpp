@@ -0,0 +1,155 @@
+#include "../lib/pacp_stats.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+
+// ==========================================
+// dashboard: 讀取 worker 的 shared-memory 狀態區段 (lib/pacp_stats.h) 並畫出儀表板
+// ==========================================
+// 不讀任何 status / 結果檔，也不 fork awk/grep；數值來自 seqlock 快照，不會撕裂。
+// Usage:
+//   ./bin/dashboard <live_stats.shm> [options]
+//     --interval <ms>   重畫間隔 (預設 500)
+//     --rows <n>        最多顯示幾個 worker (預設全部)
+//     --until-found     任一 worker 找到解 (found > 0) 就結束，exit code 0
+//     --once            只印一次 (無游標控制碼)，給其他腳本解析用
+// 區段位置:
+//   optimizer_pqcp : <root>/<L>_PACP/Workers/live_stats.shm
+//   optimizer2     : <root>/<L>/live_stats.shm
+
+static const char* C_RST = "\033[0m";
+static const char* C_GRN = "\033[1;32m";
+static const char* C_BLU = "\033[1;34m";
+static const char* C_WHT = "\033[1;37m";
+static const char* C_YEL = "\033[1;33m";
+static const char* C_RED = "\033[1;31m";
+static const char* C_CYN = "\033[1;36m";
+static const char* C_GRY = "\033[0;90m";
+
+const int64_t STALE_MS = 10000;   // 超過 10 秒沒更新視為停止
+
+struct Row {
+    int id;
+    LiveStats::Counters c;
+    bool stale;
+};
+
+static void draw_pqcp(const LiveStats::Header& h, const std::vector<Row>& rows, size_t hidden, long long elapsed,
+                      long long found, long long near, const char* eol) {
+    std::printf("%s┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓%s%s\n", C_BLU, C_RST, eol);
+    std::printf("%s┃%s PQCP Hunter | L=%-3u | Time: %-4llds | %sPQCP: %-3lld%s | %sNear: %-3lld%s ┃%s%s\n",
+                C_BLU, C_WHT, h.L, elapsed, C_GRN, found, C_WHT, C_YEL, near, C_BLU, C_RST, eol);
+    std::printf("%s┣━━━━━━┳━━━━━━━━━━┳━━━━━━━━━━┳━━━━━━┳━━━━━━┳━━━━━━━━━━━━━━━━━━━┫%s%s\n", C_BLU, C_RST, eol);
+    std::printf("%s┃%s ID   ┃ Iter     ┃ Restarts ┃ Viol ┃ Peak ┃ Status            %s┃%s%s\n", C_BLU, C_WHT, C_BLU, C_RST, eol);
+    std::printf("%s┣━━━━━━╋━━━━━━━━━━╋━━━━━━━━━━╋━━━━━━╋━━━━━━╋━━━━━━━━━━━━━━━━━━━┫%s%s\n", C_BLU, C_RST, eol);
+    for (const Row& r : rows) {
+        const char* color = C_RED;
+        std::string state = "SEARCHING";
+        if (r.stale) { color = C_GRY; state = "STOPPED"; }
+        else if (r.c.viol == 0) {
+            if (r.c.metric == 2) { color = C_WHT; state = "★ HIT ★"; }
+            else if (r.c.metric <= 6) { color = C_YEL; state = "NEAR HIT (" + std::to_string(r.c.metric) + ")"; }
+            else { color = C_GRN; state = "SHAPING"; }
+        }
+        else if (r.c.viol <= 4) { color = C_YEL; state = "CONVERGING"; }
+        // "★" 佔 3 bytes 但只顯示 1 格，printf 的寬度以 byte 計，要補回來
+        int width = 17 + (state.find("★") != std::string::npos ? 4 : 0);
+        std::printf("%s┃%s #%-3d  %s┃%s %s%-8lld%s %s┃%s %s%-8lld%s %s┃%s %s%-4lld%s %s┃%s %s%-4lld%s %s┃%s %s%-*s%s %s┃%s%s\n",
+                    C_BLU, C_RST, r.id, C_BLU, C_RST, C_GRY, (long long)r.c.iter, C_RST, C_BLU, C_RST,
+                    C_GRY, (long long)r.c.restarts, C_RST, C_BLU, C_RST, color, (long long)r.c.viol, C_RST,
+                    C_BLU, C_RST, color, (long long)r.c.metric, C_RST, C_BLU, C_RST, color, width, state.c_str(), C_RST,
+                    C_BLU, C_RST, eol);
+    }
+    std::printf("%s┗━━━━━━┻━━━━━━━━━━┻━━━━━━━━━━┻━━━━━━┻━━━━━━┻━━━━━━━━━━━━━━━━━━━┛%s%s\n", C_BLU, C_RST, eol);
+    if (hidden > 0) std::printf("  ... (Hiding %zu workers) ...%s\n", hidden, eol);
+}
+
+static void draw_goal2(const LiveStats::Header& h, const std::vector<Row>& rows, size_t hidden, long long elapsed,
+                       long long found, const char* eol) {
+    std::printf("%s┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓%s%s\n", C_BLU, C_RST, eol);
+    std::printf("%s┃%s Goal 2 Runner | L=%-3u | Workers: %-2zu | Time: %-5llds           %s┃%s%s\n",
+                C_BLU, C_WHT, h.L, rows.size() + hidden, elapsed, C_BLU, C_RST, eol);
+    std::printf("%s┣━━━━━━┳━━━━━━━━━━┳━━━━━━━━━━┳━━━━━━┳━━━━━━━━━━┳━━━━━━━━━━┳━━━━━━┫%s%s\n", C_BLU, C_RST, eol);
+    std::printf("%s┃%s ID   ┃ Iter     ┃ Restarts ┃ Viol ┃ MidVal   ┃ Found    ┃ Time ┃%s%s\n", C_BLU, C_WHT, C_RST, eol);
+    std::printf("%s┣━━━━━━╋━━━━━━━━━━╋━━━━━━━━━━╋━━━━━━╋━━━━━━━━━━╋━━━━━━━━━━╋━━━━━━┫%s%s\n", C_BLU, C_RST, eol);
+    for (const Row& r : rows) {
+        const char* color = C_WHT;
+        if (r.stale) color = C_GRY;
+        else if (r.c.found > 0) color = C_GRN;
+        else if (r.c.viol == 0) color = C_YEL;
+        else if (r.c.viol < 5) color = C_CYN;
+        std::printf("%s┃%s #%-3d %s┃%s %s%-8lld%s %s┃%s %s%-8lld%s %s┃%s %s%-4lld%s %s┃%s %s%-8lld%s %s┃%s %s%-8lld%s %s┃%s %-4s %s┃%s%s\n",
+                    C_BLU, C_RST, r.id, C_BLU, C_RST, color, (long long)r.c.iter, C_RST, C_BLU, C_RST,
+                    color, (long long)r.c.restarts, C_RST, C_BLU, C_RST, color, (long long)r.c.viol, C_RST,
+                    C_BLU, C_RST, color, (long long)r.c.metric, C_RST, C_BLU, C_RST, color, (long long)r.c.found, C_RST,
+                    C_BLU, C_RST, (std::to_string(r.c.elapsed_s) + "s").c_str(), C_BLU, C_RST, eol);
+    }
+    std::printf("%s┗━━━━━━┻━━━━━━━━━━┻━━━━━━━━━━┻━━━━━━┻━━━━━━━━━━┻━━━━━━━━━━┻━━━━━━┛%s%s\n", C_BLU, C_RST, eol);
+    if (hidden > 0) std::printf("  ... (Hiding %zu workers) ...%s\n", hidden, eol);
+    if (found > 0) std::printf("\n%s>>> SUCCESS: Found %lld sequences! (Check results folder) <<<%s%s\n", C_GRN, found, C_RST, eol);
+    else std::printf("\n%sSearching... (Press Ctrl+C to stop)%s%s\n", C_GRY, C_RST, eol);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <live_stats.shm> [--interval ms] [--rows n] [--until-found] [--once]\n";
+        return 1;
+    }
+    std::string path = argv[1];
+    int interval_ms = 500;
+    size_t max_rows = LiveStats::MAX_SLOTS;
+    bool until_found = false, once = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--interval" && i + 1 < argc) interval_ms = std::max(50, std::atoi(argv[++i]));
+        else if (a == "--rows" && i + 1 < argc) max_rows = (size_t)std::max(1, std::atoi(argv[++i]));
+        else if (a == "--until-found") until_found = true;
+        else if (a == "--once") once = true;
+        else { std::cerr << "[Error] Unknown option: " << a << "\n"; return 1; }
+    }
+
+    const char* eol = once ? "" : "\033[K";
+    auto t0 = std::chrono::steady_clock::now();
+    LiveStats::Reader rd;
+    bool ready = false;
+
+    while (true) {
+        long long elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - t0).count();
+        if (!ready) ready = rd.open(path);
+        if (!once) std::printf("\033[H");
+
+        if (!ready) {
+            std::printf("%sWaiting for workers... (%s)%s%s\n", C_GRY, path.c_str(), C_RST, eol);
+        } else {
+            const LiveStats::Header& h = rd.header();
+            int64_t now = LiveStats::now_ms();
+            std::vector<Row> rows;
+            long long found = 0, near = 0;
+            size_t total = 0;
+            for (int s = 0; s < LiveStats::MAX_SLOTS; ++s) {
+                Row r;
+                if (!rd.read(s, r.c)) continue;
+                r.id = s;
+                r.stale = (now - r.c.heartbeat_ms) > STALE_MS;
+                found += r.c.found;
+                near += r.c.near;
+                if (total++ < max_rows) rows.push_back(r);
+            }
+            size_t hidden = total - rows.size();
+            if (h.kind == LiveStats::KIND_PQCP) draw_pqcp(h, rows, hidden, elapsed, found, near, eol);
+            else draw_goal2(h, rows, hidden, elapsed, found, eol);
+            if (until_found && found > 0) {
+                std::fflush(stdout);
+                return 0;
+            }
+        }
+        if (!once) std::printf("\033[J");
+        std::fflush(stdout);
+        if (once) return ready ? 0 : 1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+}
@@ -0,0 +1,362 @@
+#include "../lib/pacp_results.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <regex>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <filesystem>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+// ==========================================
+// merge: 各台電腦的結果依 L 合併 + canonical 去重 (取代 merge12.sh / merge3.sh)
+// ==========================================
+// 以前是 find | xargs cat | sort | uniq，只能去掉完全相同的行，循環位移 / 取負 / A、B 交換的
+// 重複都會留下來。這裡:
+//   1. 多執行緒同時讀所有來源檔 (mmap；文字或 PACPRES1 二進位都可)，每行解析出 canonical 指紋
+//   2. 每個執行緒的緩衝區超過記憶體預算就排序後寫成暫存 run 檔 (外部排序，記憶體有上限)
+//   3. 所有 run 依 (指紋, 整行文字) 做 k-way merge: 同一等價類相鄰，只保留文字最小的那一行
+//   4. 留下的行再依整行文字外部排序一次 (同樣的 run 機制) 後輸出，輸出順序與 sort | uniq 相同
+// 記憶體: 約 --mem (兩個階段各用一半當緩衝區)，與等價類數量無關；其餘都在暫存 run 檔裡。
+// Usage:
+//   ./bin/merge <t1|t2> [--src DIR] [--out DIR] [--binary] [--threads N] [--mem MB]
+//     t1: <src>/*-T1-*/results/<L>/pacp_L<L>.txt  ->  <out>/L<L>_T1_merged.txt
+//     t2: <src>/*-T2-*/<L>_PACP/<L>_PQCP.txt      ->  <out>/L<L>_T2_merged.txt
+//     --binary: 輸出 lib/pacp_results.h 二進位格式 (.pacpr)
+
+struct Item {
+    uint64_t fp;
+    uint64_t off;
+    uint32_t len;
+};
+
+// 一個執行緒的緩衝區: 所有行接在一起 + 索引
+struct Chunk {
+    std::string text;
+    std::vector<Item> items;
+
+    void add(uint64_t fp, const char* b, size_t n) {
+        items.push_back({ fp, (uint64_t)text.size(), (uint32_t)n });
+        text.append(b, n);
+    }
+    size_t bytes() const { return text.size() + items.size() * sizeof(Item); }
+    // by_fp: 先比指紋再比整行 (去重階段)；否則只比整行 (輸出階段)
+    void sort_lines(bool by_fp) {
+        const char* base = text.data();
+        std::sort(items.begin(), items.end(), [base, by_fp](const Item& x, const Item& y) {
+            if (by_fp && x.fp != y.fp) return x.fp < y.fp;
+            int c = std::memcmp(base + x.off, base + y.off, std::min(x.len, y.len));
+            return c != 0 ? c < 0 : x.len < y.len;
+        });
+    }
+    void clear() {
+        text.clear();
+        items.clear();
+    }
+};
+
+struct FileCloser {
+    void operator()(std::FILE* f) const { if (f) std::fclose(f); }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+// k-way merge 的一個來源: 暫存 run 檔或留在記憶體的最後一塊
+struct Source {
+    FilePtr f;
+    const Chunk* mem = nullptr;
+    size_t pos = 0;
+    uint64_t fp = 0;
+    std::string line;
+    bool bad = false;   // run 檔讀到半筆 (被截斷或讀取錯誤)
+
+    bool next() {
+        if (mem) {
+            if (pos >= mem->items.size()) return false;
+            const Item& it = mem->items[pos++];
+            fp = it.fp;
+            line.assign(mem->text.data() + it.off, it.len);
+            return true;
+        }
+        uint32_t len;
+        size_t got = std::fread(&fp, 1, sizeof(fp), f.get());
+        if (got == 0 && !std::ferror(f.get())) return false;   // 剛好在記錄邊界結束
+        if (got != sizeof(fp) || std::fread(&len, sizeof(len), 1, f.get()) != 1) { bad = true; return false; }
+        line.resize(len);
+        if (len != 0 && std::fread(&line[0], 1, len, f.get()) != len) { bad = true; return false; }
+        return true;
+    }
+
+    bool before(const Source& o, bool by_fp) const {
+        if (by_fp && fp != o.fp) return fp < o.fp;
+        return line < o.line;
+    }
+};
+
+// 暫存 run 檔: 不論成功或中途失敗，離開 merge_length 時都刪掉
+struct TempRuns {
+    std::vector<std::string> paths;
+    ~TempRuns() { for (const std::string& p : paths) std::remove(p.c_str()); }
+};
+
+// 排序後寫成 run 檔: 每筆 [fp][len][line]；任何寫入失敗都回傳 false
+static bool spill(Chunk& c, const std::string& path, bool by_fp) {
+    c.sort_lines(by_fp);
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    static const size_t BUF = 1 << 20;
+    std::vector<char> buf(BUF);
+    std::setvbuf(f, buf.data(), _IOFBF, BUF);
+    bool ok = true;
+    for (const Item& it : c.items) {
+        if (std::fwrite(&it.fp, sizeof(it.fp), 1, f) != 1 || std::fwrite(&it.len, sizeof(it.len), 1, f) != 1 ||
+            std::fwrite(c.text.data() + it.off, 1, it.len, f) != it.len) {
+            ok = false;
+            break;
+        }
+    }
+    if (std::fclose(f) != 0) ok = false;
+    c.clear();
+    return ok;
+}
+
+// run 檔 + 記憶體中的最後一塊做 k-way merge，依序交給 emit；run 檔讀壞就回傳 false
+template <typename Emit>
+static bool merge_sources(const std::vector<std::string>& paths, const std::vector<const Chunk*>& mems, bool by_fp,
+                          Emit&& emit) {
+    std::vector<Source> sources;
+    for (const std::string& path : paths) {
+        Source s;
+        s.f.reset(std::fopen(path.c_str(), "rb"));
+        if (!s.f) return false;
+        sources.push_back(std::move(s));
+    }
+    for (const Chunk* c : mems) {
+        Source s;
+        s.mem = c;
+        sources.push_back(std::move(s));
+    }
+
+    auto cmp = [&](size_t x, size_t y) { return sources[y].before(sources[x], by_fp); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> heap(cmp);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].next()) heap.push(i);
+        else if (sources[i].bad) return false;
+    }
+    while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        Source& s = sources[i];
+        if (!emit(s)) return false;
+        if (s.next()) heap.push(i);
+        else if (s.bad) return false;
+    }
+    return true;
+}
+
+struct MergeStats {
+    long long lines = 0;
+    long long unique = 0;
+    size_t runs = 0;
+};
+
+static bool merge_length(int L, const std::vector<std::string>& files, const std::string& out_path,
+                         const std::string& tmp_prefix, bool binary, int num_threads, size_t mem_budget,
+                         MergeStats& st) {
+    num_threads = std::max(1, std::min<int>(num_threads, (int)files.size()));
+    // 讀檔階段與輸出排序階段各用一半預算
+    size_t chunk_budget = std::max<size_t>(mem_budget / 2 / num_threads, 1 << 20);
+    size_t sort_budget = std::max<size_t>(mem_budget / 2, 1 << 20);
+
+    TempRuns tmp;
+    std::vector<Chunk> chunks(num_threads);
+    std::vector<std::vector<std::string>> runs(num_threads);
+    std::atomic<size_t> next_file(0);
+    std::atomic<long long> lines(0);
+    std::atomic<bool> failed(false);
+
+    // 1. 平行讀檔 + 解析 + 超過預算就 spill
+    auto worker = [&](int tid) {
+        Chunk& c = chunks[tid];
+        PacpResults::TextRecord r;
+        std::string line;
+        long long n = 0;
+        auto maybe_spill = [&]() {
+            if (c.bytes() < chunk_budget) return;
+            std::string path = tmp_prefix + std::to_string(tid) + "_" + std::to_string(runs[tid].size()) + ".run";
+            runs[tid].push_back(path);
+            if (!spill(c, path, true)) failed = true;
+        };
+        for (size_t i = next_file++; i < files.size(); i = next_file++) {
+            if (PacpResults::is_binary_file(files[i])) {
+                PacpResults::Reader rd;
+                if (!rd.open(files[i])) continue;
+                rd.for_each([&](const PacpResults::RecordView& v) {
+                    if (v.h->L != L) return;
+                    PacpResults::format_line(*v.h, v.a, v.b, line);
+                    c.add(v.h->fingerprint, line.data(), line.size());
+                    n++;
+                    maybe_spill();
+                });
+                continue;
+            }
+            MappedFile m;
+            if (!m.open(files[i]) || m.size() == 0) continue;
+            PacpParse::LineScanner lines(m.data(), m.data() + m.size());
+            const char* p;
+            const char* t;
+            while (lines.next(p, t)) {
+                // 標頭 / 註解 / 壞行 / 其他長度的行都不收
+                if (PacpResults::parse_text(p, t, r) && r.h.L == L) {
+                    c.add(r.h.fingerprint, p, t - p);
+                    n++;
+                    maybe_spill();
+                }
+            }
+        }
+        c.sort_lines(true);
+        lines += n;
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker, t);
+    for (auto& th : threads) th.join();
+    for (auto& rs : runs) tmp.paths.insert(tmp.paths.end(), rs.begin(), rs.end());
+    if (failed) return false;
+
+    // 2. 依 (指紋, 行) merge: 同一等價類相鄰，只留第一行；留下的行再收進依文字排序的 run
+    std::vector<const Chunk*> mems;
+    for (const Chunk& c : chunks) mems.push_back(&c);
+    std::vector<std::string> sorted_runs;
+    Chunk keep;
+    bool have_prev = false;
+    uint64_t prev_fp = 0;
+    long long unique = 0;
+    bool ok = merge_sources(tmp.paths, mems, true, [&](const Source& s) {
+        if (have_prev && s.fp == prev_fp) return true;
+        have_prev = true;
+        prev_fp = s.fp;
+        unique++;
+        keep.add(s.fp, s.line.data(), s.line.size());
+        if (keep.bytes() < sort_budget) return true;
+        std::string path = tmp_prefix + "u_" + std::to_string(sorted_runs.size()) + ".run";
+        sorted_runs.push_back(path);
+        tmp.paths.push_back(path);
+        return spill(keep, path, false);
+    });
+    st.runs = tmp.paths.size() - sorted_runs.size() + chunks.size();
+    if (!ok) return false;
+    for (Chunk& c : chunks) { c.clear(); c.text.shrink_to_fit(); c.items.shrink_to_fit(); }
+    keep.sort_lines(false);
+
+    // 3. 依整行文字 merge 後輸出
+    FilePtr out;
+    PacpResults::Writer bw;
+    if (binary) {
+        if (!bw.open(out_path, true)) return false;
+    } else {
+        out.reset(std::fopen(out_path.c_str(), "wb"));
+        if (!out) return false;
+    }
+
+    PacpResults::Record r;
+    std::string buf;
+    ok = merge_sources(sorted_runs, { &keep }, false, [&](const Source& s) {
+        if (binary) {
+            if (PacpResults::parse_line(s.line.data(), s.line.data() + s.line.size(), r)) bw.write(r, 0);
+            return true;
+        }
+        buf += s.line;
+        buf += '\n';
+        if (buf.size() < (1 << 20)) return true;
+        bool w = std::fwrite(buf.data(), 1, buf.size(), out.get()) == buf.size();
+        buf.clear();
+        return w;
+    });
+    if (out) {
+        if (ok && std::fwrite(buf.data(), 1, buf.size(), out.get()) != buf.size()) ok = false;
+        if (std::fclose(out.release()) != 0) ok = false;
+    }
+    bw.close();
+    if (!ok) return false;
+
+    st.lines = lines;
+    st.unique = unique;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <t1|t2> [--src DIR] [--out DIR] [--binary] [--threads N] [--mem MB]\n";
+        return 1;
+    }
+    std::string series = argv[1];
+    std::string src_dir = "./results-c/results by computer";
+    std::string out_dir = "./results-g";
+    bool binary = false;
+    int num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    size_t mem_mb = 256;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--src" && i + 1 < argc) src_dir = argv[++i];
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (a == "--binary") binary = true;
+        else if (a == "--threads" && i + 1 < argc) num_threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--mem" && i + 1 < argc) mem_mb = (size_t)std::max(1, std::atoi(argv[++i]));
+        else { std::cerr << "[Error] Unknown option: " << a << "\n"; return 1; }
+    }
+
+    // 與原本腳本相同的路徑規則 (學號部分不限定)
+    std::regex pattern;
+    std::string tag;
+    if (series == "t1") {
+        pattern = std::regex(R"(.*-T1-[^/]*/results/([0-9]+)/pacp_L\1\.txt$)");
+        tag = "T1";
+    } else if (series == "t2") {
+        pattern = std::regex(R"(.*-T2-[^/]*/([0-9]+)_PACP/\1_PQCP\.txt$)");
+        tag = "T2";
+    } else {
+        std::cerr << "[Error] Unknown series: " << series << " (expected t1 or t2)\n";
+        return 1;
+    }
+
+    std::map<int, std::vector<std::string>> by_length;
+    std::error_code ec;
+    if (!fs::is_directory(src_dir, ec)) {
+        std::cerr << "[Error] Source directory not found: " << src_dir << "\n";
+        return 1;
+    }
+    for (auto it = fs::recursive_directory_iterator(src_dir, ec); it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) break;
+        if (!it->is_regular_file(ec)) continue;
+        std::string p = it->path().generic_string();
+        std::smatch m;
+        if (std::regex_match(p, m, pattern)) by_length[std::stoi(m[1].str())].push_back(p);
+    }
+
+    fs::create_directories(out_dir, ec);
+    std::cout << "啟動 " << tag << " 系列分流整合 (By Length, canonical dedup)...\n";
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto& kv : by_length) {
+        int L = kv.first;
+        std::sort(kv.second.begin(), kv.second.end());
+        std::string out_path = out_dir + "/L" + std::to_string(L) + "_" + tag + "_merged" + (binary ? ".pacpr" : ".txt");
+        std::string tmp_prefix = out_dir + "/.merge_L" + std::to_string(L) + "_";
+        MergeStats st;
+        std::cout << "正在處理 L=" << L << " (" << kv.second.size() << " files) ... " << std::flush;
+        if (!merge_length(L, kv.second, out_path, tmp_prefix, binary, num_threads, mem_mb << 20, st)) {
+            std::cout << "失敗\n";
+            std::cerr << "[Error] Cannot merge L=" << L << " into " << out_path << "\n";
+            return 1;
+        }
+        std::cout << "完成 (筆數: " << st.unique << " / 原始 " << st.lines << ")\n";
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "✅ " << tag << " 整合完畢。(" << by_length.size() << " lengths, " << sec << " s)\n";
+    return 0;
+}
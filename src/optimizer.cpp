@@ -1,4 +1,7 @@
 #include "../lib/pacp_core.h"
+#include "../lib/pacp_canon_index.h"
+#include "../lib/pacp_sink.h"
+#include "../lib/pacp_anneal.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -11,35 +14,19 @@
 #include <sstream>
 #include <map>
 #include <iomanip> // 用於時間格式化
+#include <csignal>
 
 namespace fs = std::filesystem;
 
+// [New] SIGTERM / SIGINT (batch_run.sh 的 timeout、Ctrl+C) 只設旗標: 退火迴圈停下後
+// 還要把 ResultSink 裡排隊的結果與 index commit 寫完，並輸出本次報告
+static volatile std::sig_atomic_t g_stop = 0;
+static void on_stop_signal(int) { g_stop = 1; }
+
 // =========================================================
 // 輔助函式
 // =========================================================
 
-long long fast_cost(const Seq& A, const Seq& B, int L, int target_val, std::vector<int>& buf_a, std::vector<int>& buf_b) {
-    compute_acf(A, buf_a);
-    compute_acf(B, buf_b);
-    return calc_mse_cost(buf_a, buf_b, L, target_val);
-}
-
-void chaos_scramble(Seq& s, std::mt19937& rng) {
-    int L = s.size();
-    if (L == 0) return;
-    int shift1 = (L * 13) / 32; if (shift1 == 0) shift1 = 1;
-    rotate_seq_left(s, shift1);
-    std::uniform_int_distribution<int> dist_idx(0, L - 1);
-    int p1 = dist_idx(rng);
-    int p2 = dist_idx(rng);
-    if (p1 > p2) std::swap(p1, p2);
-    for (int i = p1; i <= p2; ++i) s[i] *= -1;
-    int shift2 = (L * 7) / 32; if (shift2 == 0) shift2 = 1;
-    rotate_seq_left(s, L - shift2);
-    int shift3 = (L * 5) / 32; if (shift3 == 0) shift3 = 1;
-    rotate_seq_left(s, shift3);
-}
-
 void ensure_file_dir(const std::string& filepath) {
     try {
         fs::path p(filepath);
@@ -65,23 +52,21 @@ void save_seed_to_file(const std::string& filename, const Seq& A, const Seq& B)
 
 // [升級] 結果追加格式：L,PSL,A,B
 // 這樣未來找 SZCP 時，可以直接讀取前兩欄進行篩選，不用重算
-void append_result_to_file(const std::string& filename, const Seq& A, const Seq& B, int L, int psl) {
-    ensure_file_dir(filename);
-    std::ofstream outfile(filename, std::ios::app);
-    if (!outfile.is_open()) return;
-
-    // Col 1: L
-    outfile << L << ",";
-    // Col 2: PSL
-    outfile << psl << ",";
+// [New] 交給 ResultSink: 搜尋迴圈只組字串，寫檔由背景 writer thread 批次處理；
+// done 在該行寫進檔案後執行 (用來更新 canonical index)，hook 在整批寫完後執行一次 (index 的 sync)
+void append_result_to_file(const std::string& filename, const Seq& A, const Seq& B, int L, int psl,
+                           std::function<void()> done = {}, ResultSink::BatchHook hook = {}) {
+    std::string line;
+    line.reserve(2 * A.size() + 16);
+    // Col 1: L, Col 2: PSL
+    line += std::to_string(L) + "," + std::to_string(psl) + ",";
     // Col 3: A
-    for (size_t i = 0; i < A.size(); ++i) outfile << (A[i] == 1 ? '+' : '-');
-    outfile << ",";
+    ResultSink::append_pm(line, A);
+    line += ',';
     // Col 4: B
-    for (size_t i = 0; i < B.size(); ++i) outfile << (B[i] == 1 ? '+' : '-');
-    outfile << "\n";
-    
-    outfile.close();
+    ResultSink::append_pm(line, B);
+    line += '\n';
+    ResultSink::shared().submit(filename, std::move(line), std::move(done), hook);
 }
 
 // [新增] 儲存本次執行報告 (給人看的)
@@ -119,28 +104,20 @@ void save_session_report(const std::string& base_filename, int L, const std::map
 }
 
 // [讀取] 專門讀取 A,B 格式的 CSV 種子檔
+// [New] mmap + PacpResults::parse_text，只看第一行，不建 stringstream / 子字串
 bool load_seed_csv(const std::string& filename, Seq& A, Seq& B) {
-    if (!fs::exists(filename)) return false;
-    std::ifstream infile(filename);
-    if (!infile.is_open()) return false;
-
-    std::string line;
-    if (std::getline(infile, line)) {
-        line.erase(remove_if(line.begin(), line.end(), isspace), line.end());
-        size_t comma = line.find(',');
-        if (comma == std::string::npos) return false;
-
-        std::string sA = line.substr(0, comma);
-        std::string sB = line.substr(comma + 1);
-
-        if (sA.empty() || sB.empty() || sA.length() != sB.length()) return false;
-        int L = sA.length();
-        A.resize(L); B.resize(L);
-        for(int i=0; i<L; ++i) A[i] = (sA[i] == '+') ? 1 : -1;
-        for(int i=0; i<L; ++i) B[i] = (sB[i] == '+') ? 1 : -1;
-        return true;
-    }
-    return false;
+    MappedFile m;
+    if (!m.open(filename) || m.size() == 0) return false;
+    PacpParse::LineScanner lines(m.data(), m.data() + m.size());
+    const char* b;
+    const char* e;
+    PacpResults::TextRecord t;
+    if (!lines.next(b, e) || !PacpResults::parse_text(b, e, t, false)) return false;
+    if (t.h.tag != PacpResults::TAG_PAIR) return false;
+    A.resize(t.h.L); B.resize(t.h.L);
+    PacpParse::decode_pm(t.a, t.h.L, A.data());
+    PacpParse::decode_pm(t.b, t.h.L, B.data());
+    return true;
 }
 
 // =========================================================
@@ -195,251 +172,50 @@ int main(int argc, char* argv[]) {
         for(int i=0; i<L/2; ++i) { A[L-1-i]=A[i]; B[L-1-i]=-B[i]; }
     }
 
-    bool is_hard_mode = (target_val == 0);
-
-    // Aggressive Reset Strategy
-    int soft_retry_limit;
-    if (L < 40 || is_hard_mode) soft_retry_limit = 2; 
-    else soft_retry_limit = 2 + (60 / L);
-
-    long long print_interval;
-    if (L < 60) print_interval = 50000;
-    else        print_interval = 5000;
-
-    double alpha_base = (L > 60) ? 10000.0 : 6000.0;
-    double alpha = 1.0 - (1.0 / (alpha_base * L)); 
-    int max_mutation_k = std::max(1, (int)(L * 0.05));
-    double cost_norm_factor = 1.0 / (double)L;
-    
-    long long inner_max_steps = (L > 60) ? (300000LL * L) : (50000LL * L);
-    long long stagnation_limit = inner_max_steps / 4;
-
     std::cout << "--------------------------------------------------\n";
     std::cout << " OPTIMIZER v14.0 (Metadata) | L=" << L << " | Target=" << target_val << "\n";
     std::cout << " Output Format: L,PSL,A,B (Enhanced CSV)\n";
     std::cout << "--------------------------------------------------\n";
 
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> dist_01(0.0, 1.0);
-    std::uniform_int_distribution<int> dist_idx(0, L - 1);
-    std::uniform_int_distribution<int> dist_rot(1, L - 1);
-
-    std::vector<int> acf_A(L), acf_B(L);
-    long long current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
-    int best_psl = 99999; 
-
     std::vector<std::pair<Seq, Seq>> results_buffer; 
-    std::set<std::pair<std::string, std::string>> seen_canonical;
-    long long found_count = 0;
+    // [New] 去重改用結果檔旁的 canonical 指紋 index (<out_file>.cidx)，重啟時不必重算整個檔
+    ensure_file_dir(out_file);
+    CanonIndex seen_canonical;
+    if (!seen_canonical.open(out_file)) {
+        std::cerr << "[Warn] Cannot open canonical index for " << out_file << "\n";
+    }
+    std::cout << " Known classes: " << seen_canonical.size()
+              << (seen_canonical.rebuilt() ? " (index rebuilt)" : "") << "\n";
 
     // [新增] 本次執行的統計數據 (PSL -> Count)
     std::map<int, int> session_stats;
 
-    long long total_steps = 0;
-    int restart_count = 0;
-    int prev_global_best_psl = best_psl;
-    int global_stagnation_count = 0;
-
     std::cout << "[Info] Engine Started.\n";
 
-    while (target_count_arg == 0 || found_count < target_count_arg) {
-        
-        // --- Restart Decision ---
-        if (total_steps > 0) {
-            restart_count++;
-            
-            if (best_psl == prev_global_best_psl) global_stagnation_count++;
-            else { global_stagnation_count = 0; prev_global_best_psl = best_psl; }
-
-            bool do_hard_reset = false;
-            if (restart_count % soft_retry_limit == 0) do_hard_reset = true;
-            if (global_stagnation_count >= 2) do_hard_reset = true;
-
-            if (fix_a) {
-                int r = dist_rot(rng);
-                rotate_seq_left(A, r);
-                for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
-            } 
-            else if (do_hard_reset) {
-                for(int i=0; i<L; ++i) A[i] = (dist_01(rng)<0.5)?1:-1;
-                for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
-                save_seed_to_file(in_file, A, B);
-                std::cout << "\n[Restart] HARD RESET (New Seed Saved)" << std::endl;
-            } 
-            else {
-                chaos_scramble(A, rng);
-                for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
-                std::cout << "\n[Restart] Chaos Scramble" << std::endl;
-            }
-            current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
-        }
-
-        double temp = 5.0;
-        int stuck_counter = 0;
-        int stuck_threshold = (L > 60) ? (6000 * L) : (3000 * L);
-        
-        long long inner_step = 0;
-        int local_best_psl = 99999;
-        long long last_improvement_step = 0;
-
-        while (inner_step < inner_max_steps) {
-            inner_step++;
-            total_steps++;
-
-            int protection_threshold = std::max(6, L / 5);
-            if (is_hard_mode) protection_threshold += 2; 
-            bool is_promising = (local_best_psl <= protection_threshold);
-
-            if (!is_promising && (inner_step - last_improvement_step) > stagnation_limit) {
-                std::cout << " -> Stagnation (Stuck " << stagnation_limit << " steps)";
-                break; 
-            }
-
-            // 10% Flash Check
-            if (inner_step == (long long)(inner_max_steps * 0.1)) {
-                int flash_limit = (int)(L * 0.6);
-                int check_psl = calc_psl(acf_A, acf_B, L);
-                
-                if (check_psl < local_best_psl) {
-                    local_best_psl = check_psl;
-                    last_improvement_step = inner_step;
-                }
-                
-                if (check_psl <= best_psl) {
-                    std::string ca = get_canonical_repr(A);
-                    std::string cb = get_canonical_repr(B);
-                    if (ca > cb) std::swap(ca, cb);
-                    
-                    if (seen_canonical.find({ca, cb}) == seen_canonical.end()) {
-                        seen_canonical.insert({ca, cb});
-                        
-                        // [升級] 存入 L,PSL,A,B
-                        append_result_to_file(out_file, A, B, L, check_psl);
-                        session_stats[check_psl]++; // 紀錄統計
-                        
-                        std::cout << "\n[Found Result] PSL=" << check_psl << " (Saved) @ Flash Check" << std::flush;
-                        
-                        if (check_psl < best_psl) {
-                            best_psl = check_psl;
-                            prev_global_best_psl = best_psl; 
-                            found_count = 0; 
-                        } else {
-                            found_count++; 
-                        }
-                    }
-                }
-
-                if (local_best_psl > flash_limit) {
-                    std::cout << " -> Flash Exit (Bad Seed PSL=" << local_best_psl << ")";
-                    break; 
-                }
-            }
-
-            if (inner_step == (long long)(inner_max_steps * 0.3)) {
-                int limit = (L > 80) ? (L / 2) : (L / 3);
-                if (is_hard_mode) limit += 4;
-                if (local_best_psl > std::max(10, limit)) { std::cout << " -> Exit 30%"; break; }
-            }
-            if (inner_step == (long long)(inner_max_steps * 0.6)) {
-                int limit = (L > 80) ? (L / 3) : (L / 4 + 4);
-                if (is_hard_mode) limit += 6;
-                if (local_best_psl > std::max(12, limit)) { std::cout << " -> Exit 60%"; break; }
-            }
-
-            Seq old_A = A; Seq old_B = B; long long old_cost = current_cost;
-
-            bool is_rotate_move = (dist_01(rng) < 0.05);
-            if (is_rotate_move) {
-                int rot_k = dist_rot(rng);
-                if (fix_a) rotate_seq_left(A, rot_k);
-                else {
-                    if (dist_01(rng) < 0.5) rotate_seq_left(A, rot_k);
-                    else rotate_seq_left(B, rot_k);
-                }
-            } else {
-                int current_k = 1;
-                if (temp > 1.0 && max_mutation_k > 1) {
-                    std::uniform_int_distribution<int> dist_k(1, max_mutation_k);
-                    current_k = dist_k(rng);
-                }
-                for(int k=0; k<current_k; ++k) {
-                    bool flip_a = fix_a ? false : (dist_01(rng) < 0.5);
-                    if (flip_a) A[dist_idx(rng)] *= -1;
-                    else        B[dist_idx(rng)] *= -1;
-                }
-            }
-
-            long long new_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
-
-            bool accept = false;
-            if (new_cost <= current_cost) accept = true;
-            else {
-                double delta = (double)(new_cost - current_cost) * cost_norm_factor;
-                if (dist_01(rng) < std::exp(-delta / temp)) accept = true;
-            }
-
-            if (accept) {
-                current_cost = new_cost;
-                if (new_cost < old_cost) stuck_counter = 0; else stuck_counter++;
-
-                if (current_cost <= L) {
-                    int psl = calc_psl(acf_A, acf_B, L);
-                    
-                    if (psl < local_best_psl) {
-                        local_best_psl = psl;
-                        last_improvement_step = inner_step;
-                    }
-
-                    if (psl <= best_psl) {
-                        std::string ca = get_canonical_repr(A);
-                        std::string cb = get_canonical_repr(B);
-                        if (ca > cb) std::swap(ca, cb);
-                        
-                        if (seen_canonical.find({ca, cb}) == seen_canonical.end()) {
-                            seen_canonical.insert({ca, cb});
-                            
-                            // [升級] 存入 L,PSL,A,B
-                            append_result_to_file(out_file, A, B, L, psl);
-                            session_stats[psl]++; // 紀錄統計
-                            
-                            std::cout << "\n[Found Result] PSL=" << psl << " (Saved) @ Total=" << total_steps << "   " << std::flush;
-                            
-                            if (psl < best_psl) {
-                                best_psl = psl;
-                                prev_global_best_psl = best_psl; 
-                                global_stagnation_count = 0;
-                                found_count = 0; 
-                            } else {
-                                found_count++;
-                            }
-
-                            bool goal_reached = false;
-                            if (best_psl == target_val) goal_reached = true;
-                            if (target_val == 0 && best_psl <= 2) { goal_reached = true; }
-
-                            if (goal_reached && (target_count_arg > 0 && found_count >= target_count_arg)) goto FINISH;
-                        }
-                    }
-                }
-            } else {
-                A = old_A; B = old_B; current_cost = old_cost; stuck_counter++;
-            }
-
-            temp *= alpha;
-
-            if (stuck_counter > stuck_threshold || temp < 0.001) {
-                temp = 5.0; stuck_counter = 0;
-                for(int i=0; i<L; ++i) B[i] = (dist_01(rng)<0.5)?1:-1;
-                current_cost = fast_cost(A, B, L, target_val, acf_A, acf_B);
-            }
-            
-            if (inner_step % print_interval == 0) {
-                 std::cout << "\r[Running] Step=" << inner_step << " | Best=" << best_psl << " | Loc=" << local_best_psl << "   " << std::flush;
-            }
-        } 
-    }
-FINISH:
+    // [New] 退火迴圈移到 lib/pacp_anneal.h (與常駐的 pacpd 共用)，這裡只接上存檔 / 去重 / 種子
+    Anneal::Options opt;
+    opt.target_val = target_val;
+    opt.fix_a = fix_a;
+    opt.target_count = target_count_arg;
+    opt.seed = (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
+    Anneal::Hooks hooks;
+    hooks.found = [&](const Seq& a, const Seq& b, int psl) {
+        uint64_t fp = PacpResults::canonical_fingerprint(a, b);
+        if (!seen_canonical.remember(fp)) return false;
+        // [升級] 存入 L,PSL,A,B
+        append_result_to_file(out_file, a, b, L, psl, [&seen_canonical, fp] { seen_canonical.commit(fp); },
+                              { &CanonIndex::sync_hook, &seen_canonical });
+        session_stats[psl]++; // 紀錄統計
+        return true;
+    };
+    hooks.hard_reset = [&](const Seq& a, const Seq& b) { save_seed_to_file(in_file, a, b); };
+    hooks.stop = [] { return g_stop != 0; };
+    std::signal(SIGTERM, on_stop_signal);
+    std::signal(SIGINT, on_stop_signal);
+    int best_psl = Anneal::run(A, B, opt, hooks);
+
+    ResultSink::shared().flush();   // index 的 commit callback 要在 seen_canonical 解構前跑完
+    if (g_stop) std::cout << "\n[Stop] Signal received, pending results flushed.";
     std::cout << "\n[Done] Best PSL Found: " << best_psl << " | Unique Count: " << results_buffer.size() << std::endl;
     // [新增] 程式結束時，輸出本次執行的統計報告
     save_session_report(out_file, L, session_stats);
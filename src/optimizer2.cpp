@@ -15,10 +15,18 @@
 #include <iomanip>
 #include <thread>
 #include <filesystem>
+#include <csignal>
+#include "../lib/pacp_sink.h"
+#include "../lib/pacp_stats.h"
+#include "../lib/pacp_checkpoint.h"
 
 // Namespace alias for cleaner code
 namespace fs = std::filesystem;
 
+// [New] SIGTERM / SIGINT only raise a flag; the main loop writes a final checkpoint before exiting
+static volatile std::sig_atomic_t g_stop = 0;
+static void on_stop_signal(int) { g_stop = 1; }
+
 // --- 1. XorShift256 ---
 struct XorShift256 {
     uint64_t s[4];
@@ -162,59 +170,60 @@ public:
 
 // --- 4. Path Management (Fixed: No system() calls) ---
 struct PathManager {
-    std::string opt_file, szcp_file, near_file, log_file;
+    std::string opt_file, szcp_file, near_file, stats_file, ckpt_file;
+    LiveStats::Writer stats;
     
     PathManager(std::string root_dir, int L, int worker_id) {
         // Native C++ directory creation (Cross-platform, safe)
         try {
             fs::path base_path = fs::path(root_dir) / std::to_string(L);
-            fs::path worker_path = base_path / ("worker_" + std::to_string(worker_id));
             
             // Create directories recursively
-            if (!fs::exists(worker_path)) {
-                fs::create_directories(worker_path);
+            if (!fs::exists(base_path)) {
+                fs::create_directories(base_path);
             }
 
             opt_file  = (base_path / "Goal2_Opt.txt").string();
             szcp_file = (base_path / "Goal2_SZCP.txt").string();
             near_file = (base_path / "Goal2_Near.txt").string();
-            log_file  = (worker_path / "status.log").string();
+            // [New] 狀態改寫進共用的 shared-memory 區段 (bin/dashboard 讀取)，不再每次重寫 status.log
+            stats_file = (base_path / "live_stats.shm").string();
+            stats.open(stats_file, worker_id, LiveStats::KIND_GOAL2, L);
+            // [New] Per-worker crash-safe snapshot (see lib/pacp_checkpoint.h)
+            fs::create_directories(base_path / "checkpoints");
+            ckpt_file = (base_path / "checkpoints" / ("worker_" + std::to_string(worker_id) + ".ckpt")).string();
             
         } catch (const std::exception& e) {
             std::cerr << "Filesystem Error: " << e.what() << std::endl;
         }
     }
 
+    // [New] 結果行交給共用的 ResultSink (背景批次 O_APPEND 寫入)，搜尋迴圈不再開檔
     void save(const SequenceState& st, const char* type) {
         std::string target;
         if (std::strcmp(type, "OPT") == 0) target = opt_file;
         else if (std::strcmp(type, "SZCP") == 0) target = szcp_file;
         else target = near_file;
 
-        std::ofstream outfile(target, std::ios::app);
-        if (outfile.is_open()) {
-            outfile << type << ",L=" << st.L 
-                    << ",Mid=" << st.mid_val << ",";
-            
-            for(auto x : st.A) outfile << (x > 0 ? "+" : "-");
-            outfile << ",";
-            for(auto x : st.B) outfile << (x > 0 ? "+" : "-");
-            outfile << "\n";
-        }
+        std::string line = type;
+        line += ",L=" + std::to_string(st.L) + ",Mid=" + std::to_string(st.mid_val) + ",";
+        ResultSink::append_pm(line, st.A);
+        line += ',';
+        ResultSink::append_pm(line, st.B);
+        line += '\n';
+        ResultSink::shared().submit(target, std::move(line));
     }
 
-    void update_status(long long iter, int rst, int viol, int mid, long long found, double elapsed) {
-        std::ofstream stat(log_file, std::ios::trunc);
-        if (stat.is_open()) {
-            stat << "Iter: " << iter << " | Rst: " << rst 
-                 << " | ZCZ_Viol: " << viol << " | Mid: " << mid 
-                 << " | Found: " << found << " | Time: " << (long)elapsed << "s\n";
-        }
+    void update_status(long long iter, int rst, int viol, int mid, long long found, long long near, double elapsed) {
+        LiveStats::Counters c;
+        c.iter = iter; c.restarts = rst; c.viol = viol; c.metric = mid;
+        c.found = found; c.near = near; c.elapsed_s = (int64_t)elapsed;
+        stats.publish(c);
     }
 };
 
 // --- 5. Main Solver ---
-void run_solver(int L, std::string results_root, int wid, long long time_limit) {
+void run_solver(int L, std::string results_root, int wid, long long time_limit, bool resume, int ckpt_sec) {
     if (L % 2 != 0) {
         std::cerr << "Error: Length must be even for Goal 2." << std::endl;
         return;
@@ -231,7 +240,7 @@ void run_solver(int L, std::string results_root, int wid, long long time_limit)
     int BIG_KICK   = L * 200;
     int RESTART    = L * 3000;
     
-    long long iter = 0, found = 0, restarts = 0;
+    long long iter = 0, found = 0, near = 0, restarts = 0;
     int stuck = 0, total_stuck = 0;
     auto start_time = std::chrono::steady_clock::now();
 
@@ -240,7 +249,56 @@ void run_solver(int L, std::string results_root, int wid, long long time_limit)
         stuck = 0; total_stuck = 0; tabu.clear(); restarts++;
     };
 
-    full_restart();
+    // [New] Snapshot: sequences, sum_rho, tabu list, RNG state and counters
+    //       (ext buffers and metrics are rebuilt from these on resume)
+    Checkpoint ckpt;
+    auto save_checkpoint = [&]() {
+        ResultSink::shared().flush();   // results counted in the snapshot must already be on disk
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        ckpt.clear();
+        ckpt.put_vec(st.A); ckpt.put_vec(st.B); ckpt.put_vec(st.sum_rho);
+        ckpt.put_vec(tabu.data); ckpt.put<uint64_t>(tabu.idx);
+        ckpt.put(rng);
+        ckpt.put(iter); ckpt.put(found); ckpt.put(near); ckpt.put(restarts);
+        ckpt.put(stuck); ckpt.put(total_stuck); ckpt.put(elapsed);
+        if (!ckpt.save(paths.ckpt_file, LiveStats::KIND_GOAL2, L))
+            std::cerr << "[Warn] Cannot write checkpoint " << paths.ckpt_file << std::endl;
+    };
+    // Only applied when every field reads back, so a bad snapshot never leaves half a state
+    auto load_checkpoint = [&]() -> bool {
+        if (!ckpt.load(paths.ckpt_file, LiveStats::KIND_GOAL2, L)) return false;
+        std::vector<int8_t> A, B;
+        std::vector<int> sum_rho, td;
+        uint64_t tabu_idx = 0;
+        XorShift256 r(0);
+        long long it = 0, fd = 0, nr = 0, rs = 0;
+        int sk = 0, tsk = 0;
+        double elapsed = 0;
+        if (!ckpt.get_vec(A, L) || !ckpt.get_vec(B, L) || !ckpt.get_vec(sum_rho, L) ||
+            !ckpt.get_vec(td, tabu.data.size()) || !ckpt.get(tabu_idx) || tabu_idx >= td.size() || !ckpt.get(r) ||
+            !ckpt.get(it) || !ckpt.get(fd) || !ckpt.get(nr) || !ckpt.get(rs) ||
+            !ckpt.get(sk) || !ckpt.get(tsk) || !ckpt.get(elapsed))
+            return false;
+        st.A = A; st.B = B; st.sum_rho = sum_rho;
+        st.sync_buffers(); st.update_metrics();
+        tabu.data = td; tabu.idx = tabu_idx;
+        rng = r;
+        iter = it; found = fd; near = nr; restarts = rs;
+        stuck = sk; total_stuck = tsk;
+        // time_limit counts the whole run, including time before the restart
+        start_time -= std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(elapsed));
+        return true;
+    };
+
+    if (resume && load_checkpoint()) {
+        std::cerr << "[Resume] L=" << L << " worker " << wid << " from iter " << iter << std::endl;
+    } else {
+        if (resume) std::cerr << "[Resume] No valid checkpoint at " << paths.ckpt_file << ", starting fresh" << std::endl;
+        full_restart();
+    }
+    std::signal(SIGTERM, on_stop_signal);
+    std::signal(SIGINT, on_stop_signal);
+    auto last_ckpt = std::chrono::steady_clock::now();
     const int SLEEP_BATCH = 4096; 
 
     while (true) {
@@ -263,7 +321,7 @@ void run_solver(int L, std::string results_root, int wid, long long time_limit)
                 st.mutate(rng, std::max(4, L/3)); stuck=0; tabu.clear(); continue;
             }
             else if (st.mid_val > 4) {
-                if (rng.next_double() < 0.1) paths.save(st, "NEAR");
+                if (rng.next_double() < 0.1) { paths.save(st, "NEAR"); near++; }
                 st.mutate(rng, 2); stuck=0; tabu.clear(); continue;
             }
         }
@@ -303,16 +361,34 @@ void run_solver(int L, std::string results_root, int wid, long long time_limit)
         if (total_stuck > BIG_KICK) { st.mutate(rng, std::max(6, L/4)); total_stuck = 0; tabu.clear(); }
         if (total_stuck > RESTART) full_restart();
 
-        if ((iter & 32767) == 0) {
+        if ((iter & 4095) == 0) {
             double elap = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
-            paths.update_status(iter, restarts, st.zcz_violations, st.mid_val, found, elap);
+            paths.update_status(iter, restarts, st.zcz_violations, st.mid_val, found, near, elap);
+            // [New] Checkpoint every ckpt_sec seconds; on a stop signal write one last snapshot and exit
+            auto now = std::chrono::steady_clock::now();
+            if (ckpt_sec > 0 && (g_stop || now - last_ckpt >= std::chrono::seconds(ckpt_sec))) {
+                save_checkpoint();
+                last_ckpt = now;
+            }
+            if (g_stop) break;
         }
     }
 }
 
 int main(int argc, char* argv[]) {
     std::ios_base::sync_with_stdio(false);
+    // Usage: optimizer2 <L> <results_root> <worker_id> <time_limit> [--resume] [--checkpoint-sec N]
+    //   --resume            continue from <results_root>/<L>/checkpoints/worker_<id>.ckpt (fresh start if none)
+    //   --checkpoint-sec N  snapshot interval in seconds (default 10, 0 = off)
     if (argc < 5) return 1;
-    run_solver(std::stoi(argv[1]), argv[2], std::stoi(argv[3]), std::stoll(argv[4]));
+    bool resume = false;
+    int ckpt_sec = 10;
+    for (int i = 5; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--resume") resume = true;
+        else if (a == "--checkpoint-sec" && i + 1 < argc) ckpt_sec = std::max(0, std::atoi(argv[++i]));
+        else if (a.rfind("--", 0) == 0) { std::cerr << "[Error] Unknown option: " << a << std::endl; return 1; }
+    }
+    run_solver(std::stoi(argv[1]), argv[2], std::stoi(argv[3]), std::stoll(argv[4]), resume, ckpt_sec);
     return 0;
 }
\ No newline at end of file
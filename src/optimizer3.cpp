@@ -16,6 +16,7 @@
 #include <sstream>
 #include <filesystem>
 #include <cstring>
+#include "../lib/pacp_sink.h"
 
 namespace fs = std::filesystem;
 
@@ -149,17 +150,15 @@ void save_result(const std::string& out_dir, const SequenceState& st) {
 
     ss << clean_dir << "/L" << st.L << "_PSL" << max_s << "_" << std::hex << rd() << ".csv";
     
-    std::ofstream outfile(ss.str());
-    if (outfile.is_open()) {
-        outfile << st.L << "," << max_s << ",";
-        for(auto x : st.A) outfile << (x==1 ? '+' : '-'); 
-        outfile << ",";
-        for(auto x : st.B) outfile << (x==1 ? '+' : '-');
-        outfile << "\n";
-        outfile.flush();
-        outfile.close();
-        std::cout << "[SYSTEM] Saved: " << ss.str() << std::endl;
-    }
+    // [New] 經由 ResultSink 寫出；找到解後 worker 就結束，所以這裡等它真的落地再回報
+    std::string line = std::to_string(st.L) + "," + std::to_string(max_s) + ",";
+    ResultSink::append_pm(line, st.A);
+    line += ',';
+    ResultSink::append_pm(line, st.B);
+    line += '\n';
+    ResultSink::shared().submit(ss.str(), std::move(line));
+    ResultSink::shared().flush();
+    std::cout << "[SYSTEM] Saved: " << ss.str() << std::endl;
 }
 
 // --- Solver Logic ---
@@ -23,7 +23,15 @@
 #include <thread>
 #include <filesystem>
 #include <deque>
+#include <csignal>
 #include "../lib/pqcp_tuner.h" 
+#include "../lib/pacp_sink.h"
+#include "../lib/pacp_stats.h"
+#include "../lib/pacp_checkpoint.h"
+
+// [New] SIGTERM / SIGINT (關機、pkill、Ctrl+C) 只設旗標，主迴圈寫完最後一次快照再結束
+static volatile std::sig_atomic_t g_stop = 0;
+static void on_stop_signal(int) { g_stop = 1; }
 
 // --- RNG ---
 struct XorShift256 {
@@ -203,39 +211,50 @@ public:
 
 // --- Path Management ---
 struct PathManager {
-    std::string sol_file, near_file, status_file;
+    std::string sol_file, near_file, stats_file, ckpt_file;
+    LiveStats::Writer stats;
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
     PathManager(std::string root, int L, int worker_id) {
         std::string main_dir = root + "/" + std::to_string(L) + "_PACP";
-        std::string worker_dir = main_dir + "/Workers/Worker_" + std::to_string(worker_id);
-        std::string cmd = "mkdir -p \"" + worker_dir + "\"";
+        std::string workers_dir = main_dir + "/Workers";
+        std::string cmd = "mkdir -p \"" + workers_dir + "\"";
         system(cmd.c_str());
         sol_file = main_dir + "/" + std::to_string(L) + "_PQCP.txt";
         near_file = main_dir + "/" + std::to_string(L) + "_near.txt";
-        status_file = worker_dir + "/status.txt";
+        // [New] 狀態改寫進共用的 shared-memory 區段 (bin/dashboard 讀取)，不再每次重寫 status.txt
+        stats_file = workers_dir + "/live_stats.shm";
+        stats.open(stats_file, worker_id, LiveStats::KIND_PQCP, L);
+        // [New] 快照放在 Checkpoints/ (run_pqcp.sh 啟動時會清掉 Workers/)
+        std::string ckpt_dir = main_dir + "/Checkpoints";
+        std::filesystem::create_directories(ckpt_dir);
+        ckpt_file = ckpt_dir + "/worker_" + std::to_string(worker_id) + ".ckpt";
     }
+    // [New] 結果行交給共用的 ResultSink (背景批次 O_APPEND 寫入)，搜尋迴圈不再開檔
+    int sol_chan = -1, near_chan = -1;
     void save(const SequenceState& st, bool is_strict) {
-        std::string target = is_strict ? sol_file : near_file;
-        std::ofstream outfile(target, std::ios::app);
-        if (outfile.is_open()) {
-            outfile << (is_strict ? "PQCP" : "NEAR") << ",L=" << st.L 
-                    << ",Max=" << st.max_sidelobe 
-                    << ",Peaks=" << st.peak_count << ",";
-            for(auto x : st.A) outfile << (x > 0 ? "+" : "-");
-            outfile << ",";
-            for(auto x : st.B) outfile << (x > 0 ? "+" : "-");
-            outfile << "\n";
+        if (sol_chan < 0) {
+            sol_chan = ResultSink::shared().channel(sol_file);
+            near_chan = ResultSink::shared().channel(near_file);
         }
+        std::string line = is_strict ? "PQCP" : "NEAR";
+        line += ",L=" + std::to_string(st.L) + ",Max=" + std::to_string(st.max_sidelobe)
+              + ",Peaks=" + std::to_string(st.peak_count) + ",";
+        ResultSink::append_pm(line, st.A);
+        line += ',';
+        ResultSink::append_pm(line, st.B);
+        line += '\n';
+        ResultSink::shared().submit(is_strict ? sol_chan : near_chan, std::move(line));
     }
-    void update_dashboard(long long iter, int rst, int viol, int peaks, long long found) {
-        std::ofstream stat(status_file, std::ios::trunc);
-        if (stat.is_open()) {
-            stat << "Iter=" << iter << " Rst=" << rst << " Viol=" << viol 
-                 << " Peaks=" << peaks << " Sol=" << found << "\n";
-        }
+    void update_dashboard(long long iter, int rst, int viol, int peaks, long long found, long long near) {
+        LiveStats::Counters c;
+        c.iter = iter; c.restarts = rst; c.viol = viol; c.metric = peaks;
+        c.found = found; c.near = near;
+        c.elapsed_s = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_time).count();
+        stats.publish(c);
     }
 };
 
-void run_solver(int L, const std::string& out_dir, int worker_id) {
+void run_solver(int L, const std::string& out_dir, int worker_id, bool resume, int ckpt_sec) {
     uint64_t seed_val = (uint64_t)worker_id * 0x5851F42D4C957F2D + 
                         (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
     XorShift256 rng(seed_val);
@@ -251,6 +270,7 @@ void run_solver(int L, const std::string& out_dir, int worker_id) {
     int stuck = 0;
     int total_stuck = 0;
     long long found_count = 0;
+    long long near_count = 0;
     long long total_restarts = 0;
 
     auto full_restart = [&]() {
@@ -259,7 +279,55 @@ void run_solver(int L, const std::string& out_dir, int worker_id) {
         total_restarts++;
     };
 
-    full_restart();
+    // [New] 快照: 序列、sum_rho、tabu、RNG、計數器 (ext buffer 與 metrics 可由這些重建)
+    Checkpoint ckpt;
+    auto save_checkpoint = [&]() {
+        ResultSink::shared().flush();   // 快照裡的計數器對應的結果行要先落地
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - paths.start_time).count();
+        ckpt.clear();
+        ckpt.put_vec(st.A); ckpt.put_vec(st.B); ckpt.put_vec(st.sum_rho);
+        ckpt.put_vec(tabu.data); ckpt.put<uint64_t>(tabu.idx);
+        ckpt.put(rng);
+        ckpt.put(iter); ckpt.put(stuck); ckpt.put(total_stuck);
+        ckpt.put(found_count); ckpt.put(near_count); ckpt.put(total_restarts); ckpt.put(elapsed);
+        if (!ckpt.save(paths.ckpt_file, LiveStats::KIND_PQCP, L))
+            std::cerr << "[Warn] Cannot write checkpoint " << paths.ckpt_file << std::endl;
+    };
+    // 全部欄位讀成功才套用，壞掉的快照不會留下半套狀態
+    auto load_checkpoint = [&]() -> bool {
+        if (!ckpt.load(paths.ckpt_file, LiveStats::KIND_PQCP, L)) return false;
+        std::vector<int8_t> A, B;
+        std::vector<int> sum_rho;
+        uint64_t tabu_idx = 0;
+        XorShift256 r(0);
+        long long it = 0, fc = 0, nc = 0, tr = 0;
+        int sk = 0, tsk = 0;
+        int64_t elapsed = 0;
+        std::vector<int> td;
+        if (!ckpt.get_vec(A, L) || !ckpt.get_vec(B, L) || !ckpt.get_vec(sum_rho, L) ||
+            !ckpt.get_vec(td, tabu.data.size()) || !ckpt.get(tabu_idx) || tabu_idx >= td.size() || !ckpt.get(r) ||
+            !ckpt.get(it) || !ckpt.get(sk) || !ckpt.get(tsk) || !ckpt.get(fc) || !ckpt.get(nc) || !ckpt.get(tr) ||
+            !ckpt.get(elapsed))
+            return false;
+        st.A = A; st.B = B; st.sum_rho = sum_rho;
+        st.sync_buffers(); st.update_metrics();
+        tabu.data = td; tabu.idx = tabu_idx;
+        rng = r;
+        iter = it; stuck = sk; total_stuck = tsk;
+        found_count = fc; near_count = nc; total_restarts = tr;
+        paths.start_time -= std::chrono::seconds(elapsed);
+        return true;
+    };
+
+    if (resume && load_checkpoint()) {
+        std::cerr << "[Resume] L=" << L << " worker " << worker_id << " from iter " << iter << std::endl;
+    } else {
+        if (resume) std::cerr << "[Resume] No valid checkpoint at " << paths.ckpt_file << ", starting fresh" << std::endl;
+        full_restart();
+    }
+    std::signal(SIGTERM, on_stop_signal);
+    std::signal(SIGINT, on_stop_signal);
+    auto last_ckpt = std::chrono::steady_clock::now();
 
     // [CPU Cooling] 強制更頻繁的休眠
     const int SLEEP_BATCH = 2048; 
@@ -278,7 +346,7 @@ void run_solver(int L, const std::string& out_dir, int worker_id) {
                 st.mutate(rng, std::max(4, L/3)); stuck = 0; tabu.clear(); continue;
             } 
             else if (st.peak_count <= 4) { 
-                if (rng.next_double() < 0.2) paths.save(st, false);
+                if (rng.next_double() < 0.2) { paths.save(st, false); near_count++; }
             }
         }
 
@@ -347,9 +415,16 @@ void run_solver(int L, const std::string& out_dir, int worker_id) {
         if (total_stuck > BIG_KICK_LIMIT) { st.mutate(rng, std::max(6, L/4)); total_stuck = 0; tabu.clear(); }
         if (total_stuck > RESTART_LIMIT) full_restart();
 
-        // 降低 I/O 頻率，避免 Race Condition
-        if (iter % 50000 == 0) {
-            paths.update_dashboard(iter, total_restarts, st.violations, st.peak_count, found_count);
+        // [New] 發佈到 shared-memory 區段只是幾個 atomic store，可以比以前的 50000 次更頻繁
+        if ((iter & 4095) == 0) {
+            paths.update_dashboard(iter, total_restarts, st.violations, st.peak_count, found_count, near_count);
+            // [New] 每 ckpt_sec 秒寫一次快照；收到停止訊號時寫完最後一次就結束
+            auto now = std::chrono::steady_clock::now();
+            if (ckpt_sec > 0 && (g_stop || now - last_ckpt >= std::chrono::seconds(ckpt_sec))) {
+                save_checkpoint();
+                last_ckpt = now;
+            }
+            if (g_stop) return;
         }
     }
 }
@@ -357,7 +432,18 @@ void run_solver(int L, const std::string& out_dir, int worker_id) {
 int main(int argc, char* argv[]) {
     std::ios_base::sync_with_stdio(false);
     std::cin.tie(NULL);
+    // Usage: optimizer_pqcp <L> <out_dir> <worker_id> [--resume] [--checkpoint-sec N]
+    //   --resume            從 <out_dir>/<L>_PACP/Checkpoints/worker_<id>.ckpt 接續 (沒有快照就重新開始)
+    //   --checkpoint-sec N  每 N 秒寫一次快照 (預設 10，0 = 關閉)
     if (argc < 4) return 1;
-    run_solver(std::stoi(argv[1]), argv[2], std::stoi(argv[3]));
+    bool resume = false;
+    int ckpt_sec = 10;
+    for (int i = 4; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--resume") resume = true;
+        else if (a == "--checkpoint-sec" && i + 1 < argc) ckpt_sec = std::max(0, std::atoi(argv[++i]));
+        else { std::cerr << "[Error] Unknown option: " << a << std::endl; return 1; }
+    }
+    run_solver(std::stoi(argv[1]), argv[2], std::stoi(argv[3]), resume, ckpt_sec);
     return 0;
 }
\ No newline at end of file
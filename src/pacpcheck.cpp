@@ -1,8 +1,15 @@
 /*
     PACP/PQCP Interactive Analyzer (Full Spectrum)
     Ref: Optimal Binary Periodic Almost-Complementary Pairs
+    Usage:
+      ./bin/pacpcheck                 interactive, one pair per line
+      ./bin/pacpcheck --batch [--format csv|json] [--out FILE] [--summary FILE] [--threads N]
+                      [--zcz-min Z] [--no-header] [--quiet] [FILE|-]...
+        Checks every pair in the given results files (any text dialect or .pacpr, stdin if none)
+        in parallel and prints one verdict per pair: PERFECT / NEAR / FAIL.
 */
 
+#include "../lib/pacp_batch.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -200,7 +207,27 @@ void analyze_pair(const std::vector<int>& A, const std::vector<int>& B) {
     std::cout << std::endl;
 }
 
-int main() {
+// --- Batch verdict (same rules as analyze_pair) ---
+const char* batch_verdict(const Verify::Profile& p, int mid) {
+    if (p.L % 2 != 0) return (p.classes & Verify::ODD_OPT) ? "PERFECT" : "FAIL";
+    bool zone = p.zcz >= p.L / 2;
+    if (zone && mid == 4) return "PERFECT";
+    if (zone && mid > 4) return "NEAR";
+    return "FAIL";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::string err;
+        BatchCheck::Options opt;
+        if (std::string(argv[1]) != "--batch" || !BatchCheck::parse_args(argc, argv, 2, opt, err)) {
+            if (!err.empty()) std::cerr << "[Error] " << err << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [" << BatchCheck::usage() << "]" << std::endl;
+            return 1;
+        }
+        return BatchCheck::run(opt, batch_verdict);
+    }
+
     std::string line;
     std::cout << C_WHT << "=== PACP/PQCP Full Spectrum Analyzer ===" << C_RST << std::endl;
     std::cout << "Supports Optimal PACP check for Even & Odd lengths." << std::endl;
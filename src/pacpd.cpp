@@ -0,0 +1,489 @@
+#include "../lib/pacp_core.h"
+#include "../lib/pacp_canon_index.h"
+#include "../lib/pacp_sink.h"
+#include "../lib/pacp_anneal.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+// ==========================================
+// pacpd: 常駐搜尋 daemon + 本機 spool 工作佇列 (取代一個 L 開一次 run.sh / batch_run.sh)
+// ==========================================
+// 以前每個 L 都是新行程: 產生種子、重讀結果檔的 canonical index、跑完就結束，
+// batch_run.sh 每個 L 還要再跑一次 make。pacpd 只啟動一次:
+//   - 固定大小的 worker 執行緒池 (Goal 1 / Goal 2 退火引擎，lib/pacp_anneal.h)
+//   - 每個 L 的 CanonIndex 第一次用到時載入，之後所有 job 共用、常駐記憶體
+//   - 多個 job 同時執行時動態分配核心: worker 總是挑目前人數最少的 job，
+//     人數比別的 job 多 2 以上時在下一個檢查點 (4096 步) 讓出，重新分配
+// Spool 目錄 (--spool，預設 ./spool):
+//   incoming/<id>.job   新工作 (key=value，空白或換行分隔；寫入時請先寫暫存名再 mv，'.' 開頭的檔會被忽略)
+//                          L=<L>  [goal=1|2]  [count=N]  [budget=SEC]  [threads=N]
+//                          goal 省略時依奇偶決定；count: 達標 (PSL <= target，偶數為 2) 筆數，0 = 不限；
+//                          budget: 秒數，0 = 不限；threads: 此 job 最多幾個 worker
+//   running/<id>.job    執行中 (daemon 重啟時會放回 incoming)
+//   done/, failed/      結束 / 參數錯誤的 job 檔
+//   out/<id>.txt        這個 job 找到的結果 (L,PSL,A,B，找到就即時寫入)
+//   out/<id>.status     狀態 (每秒更新；state=running|done|failed|requeued)
+//   cancel/<id>         建立這個檔就取消該 job
+// 結果同時寫進 <results>/<L>/pacp_L<L>.txt (與 run.sh 相同位置，merge / classify 不用改)。
+// Usage:
+//   ./bin/pacpd [--spool DIR] [--results DIR] [--threads N] [--poll-ms MS] [--exit-when-idle]
+//   ./submit.sh <Start_L> <End_L> <Count> <Budget_sec> [--spool DIR] [--threads N] [--wait]   (見 submit.sh)
+
+// Goal 2 白名單 (必須與 run.sh / batch_run.sh 一致)
+static const int GOAL2_LIST[] = { 6, 12, 14, 22, 24, 28, 30, 38, 42, 48, 54, 56, 60, 62, 66, 70, 76, 78, 84, 88, 92,
+                                  96, 102, 108, 114, 118, 120, 124, 126, 132, 134, 138, 142, 150, 158, 166, 168, 172,
+                                  176, 182, 192, 198 };
+
+static std::atomic<bool> g_stop(false);
+
+static void on_signal(int) { g_stop = true; }
+
+// 同一個 L 的結果檔 + canonical index (daemon 生命週期內只載入一次)
+struct LengthIndex {
+    std::string results;
+    CanonIndex index;
+    std::mutex mu;   // remember 在 worker 上；commit 在 ResultSink 的 writer thread 上 (只寫 sidecar)
+};
+
+struct Job {
+    std::string id;
+    int L = 0;
+    int goal = 0;
+    int target_val = 0;
+    int goal_psl = 0;          // PSL <= goal_psl 算達標
+    bool fix_a = false;
+    long long count = 0;
+    double budget = 0;
+    int max_threads = 0;       // 0: 不限
+    uint64_t seq = 0;          // 到達順序
+    Clock::time_point start;
+    std::string stream;
+    LengthIndex* index = nullptr;
+
+    std::atomic<bool> done{ false };
+    std::atomic<long long> found{ 0 };
+    std::atomic<long long> hits{ 0 };
+    std::atomic<int> best_psl{ 99999 };
+    std::string reason;        // 由 scheduler 或 found hook (持有 mu) 設定
+    int active = 0;            // 目前在跑的 worker 數 (持有 mu)
+
+    int cap(int threads) const { return max_threads > 0 ? std::min(max_threads, threads) : threads; }
+};
+
+class Daemon {
+public:
+    Daemon(std::string spool, std::string results, int threads, int poll_ms, bool exit_when_idle)
+        : spool_(std::move(spool)), results_(std::move(results)), threads_(threads), poll_ms_(poll_ms),
+          exit_when_idle_(exit_when_idle) {}
+
+    int run() {
+        std::error_code ec;
+        for (const char* d : { "incoming", "running", "done", "failed", "out", "cancel" }) {
+            fs::create_directories(spool_ + "/" + d, ec);
+            if (ec) {
+                std::cerr << "[Error] Cannot create " << spool_ << "/" << d << ": " << ec.message() << "\n";
+                return 1;
+            }
+        }
+        recover();
+
+        std::cout << "[pacpd] spool=" << spool_ << " results=" << results_ << " threads=" << threads_ << std::endl;
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads_; ++t) pool.emplace_back([this, t] { worker(t); });
+
+        auto last_status = Clock::now() - std::chrono::seconds(10);
+        while (!g_stop) {
+            accept_jobs();
+            check_cancel_and_budget();
+            finish_jobs();
+            if (Clock::now() - last_status >= std::chrono::seconds(1)) {
+                std::lock_guard<std::mutex> lk(mu_);
+                for (auto& j : jobs_) write_status(*j, "running");
+                last_status = Clock::now();
+            }
+            if (exit_when_idle_ && idle()) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms_));
+        }
+
+        // 收工: worker 在下一個檢查點結束，未完成的 job 放回 incoming (下次啟動繼續)；
+        // 已經結束 (達標 / 預算 / 取消) 但還沒來得及收尾的照常移到 done/
+        g_stop = true;
+        cv_.notify_all();
+        for (auto& th : pool) th.join();
+        ResultSink::shared().flush();
+        for (auto& j : jobs_) {
+            if (j->done) {
+                complete(*j);
+                continue;
+            }
+            fs::rename(job_path("running", j->id), job_path("incoming", j->id), ec_);
+            ResultSink::shared().release(j->stream);
+            write_status(*j, "requeued");
+            std::cout << "[Requeue] " << j->id << " (L=" << j->L << ", found " << j->found << ")" << std::endl;
+        }
+        std::cout << "[pacpd] stopped." << std::endl;
+        return 0;
+    }
+
+private:
+    std::string spool_, results_;
+    int threads_, poll_ms_;
+    bool exit_when_idle_;
+    std::error_code ec_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Job>> jobs_;
+    std::map<int, std::unique_ptr<LengthIndex>> indexes_;
+    uint64_t next_seq_ = 0;
+
+    std::string job_path(const char* dir, const std::string& id) const {
+        return spool_ + "/" + dir + "/" + id + ".job";
+    }
+
+    // 上次沒有正常結束時留在 running/ 的 job 放回 incoming
+    void recover() {
+        std::vector<fs::path> left;
+        for (auto it = fs::directory_iterator(spool_ + "/running", ec_); it != fs::directory_iterator(); it.increment(ec_)) {
+            if (ec_) break;
+            if (it->path().extension() == ".job") left.push_back(it->path());
+        }
+        for (const fs::path& p : left) {
+            fs::rename(p, spool_ + "/incoming/" + p.filename().string(), ec_);
+            std::cout << "[Recover] " << p.stem().string() << " -> incoming" << std::endl;
+        }
+    }
+
+    bool idle() {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!jobs_.empty()) return false;
+        for (auto it = fs::directory_iterator(spool_ + "/incoming", ec_); it != fs::directory_iterator(); it.increment(ec_)) {
+            if (ec_) break;
+            std::string name = it->path().filename().string();
+            if (name[0] != '.' && it->path().extension() == ".job") return false;
+        }
+        return true;
+    }
+
+    /* ---------- 工作檔 ---------- */
+    static bool goal2_allowed(int L) {
+        return std::find(std::begin(GOAL2_LIST), std::end(GOAL2_LIST), L) != std::end(GOAL2_LIST);
+    }
+
+    static bool is_prime(int n) {
+        if (n <= 1) return false;
+        for (int i = 2; i * i <= n; i++) if (n % i == 0) return false;
+        return true;
+    }
+
+    // 解析 key=value；錯誤時回傳說明
+    static std::string parse_job(const std::string& path, Job& j) {
+        std::ifstream in(path);
+        if (!in.is_open()) return "cannot read job file";
+        std::stringstream ss;
+        ss << in.rdbuf();
+        std::string tok;
+        while (ss >> tok) {
+            if (tok[0] == '#') {
+                std::string rest;
+                std::getline(ss, rest);
+                continue;
+            }
+            size_t eq = tok.find('=');
+            if (eq == std::string::npos) return "bad token '" + tok + "' (expected key=value)";
+            std::string k = tok.substr(0, eq), v = tok.substr(eq + 1);
+            try {
+                if (k == "L") j.L = std::stoi(v);
+                else if (k == "goal") j.goal = std::stoi(v);
+                else if (k == "count") j.count = std::stoll(v);
+                else if (k == "budget") j.budget = std::stod(v);
+                else if (k == "threads") j.max_threads = std::stoi(v);
+                else return "unknown key '" + k + "'";
+            } catch (...) {
+                return "bad value for '" + k + "'";
+            }
+        }
+        if (j.L < 4) return "L must be >= 4";
+        if (j.goal == 0) j.goal = (j.L % 2 != 0) ? 1 : 2;
+        if (j.goal == 3) return "goal 3 (PQCP) is served by optimizer_pqcp / run_pqcp.sh, not pacpd";
+        if (j.goal == 1 && j.L % 2 == 0) return "goal 1 needs an odd L";
+        if (j.goal == 2 && (j.L % 2 != 0 || !goal2_allowed(j.L))) return "L is not in the Goal 2 (Opt-PACP) list";
+        if (j.goal != 1 && j.goal != 2) return "goal must be 1 or 2";
+        if (j.count < 0 || j.budget < 0 || j.max_threads < 0) return "count / budget / threads must be >= 0";
+
+        // 與 run.sh 相同: 奇數 target 2，質數且 L = 3 mod 4 時鎖定 Legendre A (optimizer 在 L < 20 時不鎖)
+        j.target_val = (j.goal == 1) ? 2 : 0;
+        j.goal_psl = (j.target_val == 0) ? 2 : j.target_val;
+        j.fix_a = (j.goal == 1) && is_prime(j.L) && (j.L % 4 == 3) && j.L >= 20;
+        return "";
+    }
+
+    LengthIndex* index_for(int L) {
+        auto& slot = indexes_[L];
+        if (slot) return slot.get();
+        slot = std::make_unique<LengthIndex>();
+        slot->results = results_ + "/" + std::to_string(L) + "/pacp_L" + std::to_string(L) + ".txt";
+        fs::create_directories(fs::path(slot->results).parent_path(), ec_);
+        if (!slot->index.open(slot->results)) {
+            std::cerr << "[Warn] Cannot open canonical index for " << slot->results << "\n";
+        }
+        std::cout << "[Index] L=" << L << " known classes: " << slot->index.size()
+                  << (slot->index.rebuilt() ? " (index rebuilt)" : "") << std::endl;
+        return slot.get();
+    }
+
+    void accept_jobs() {
+        std::vector<fs::path> files;
+        for (auto it = fs::directory_iterator(spool_ + "/incoming", ec_); it != fs::directory_iterator(); it.increment(ec_)) {
+            if (ec_) break;
+            std::string name = it->path().filename().string();
+            if (name[0] != '.' && it->path().extension() == ".job") files.push_back(it->path());
+        }
+        std::sort(files.begin(), files.end());
+        bool added = false;
+        for (const fs::path& p : files) {
+            std::string id = p.stem().string();
+            std::string running = job_path("running", id);
+            fs::rename(p, running, ec_);   // 認領 (rename 是原子的)
+            if (ec_) continue;
+
+            auto j = std::make_unique<Job>();
+            j->id = id;
+            std::string err = parse_job(running, *j);
+            if (!err.empty()) {
+                fs::rename(running, job_path("failed", id), ec_);
+                j->reason = err;
+                write_status(*j, "failed");
+                std::cout << "[Reject] " << id << ": " << err << std::endl;
+                continue;
+            }
+            j->stream = spool_ + "/out/" + id + ".txt";
+            j->start = Clock::now();
+            j->index = index_for(j->L);
+            std::cout << "[Job] " << id << " L=" << j->L << " goal=" << j->goal << " count=" << j->count
+                      << " budget=" << j->budget << "s" << (j->fix_a ? " (Legendre A)" : "") << std::endl;
+            std::lock_guard<std::mutex> lk(mu_);
+            j->seq = next_seq_++;
+            write_status(*j, "running");
+            jobs_.push_back(std::move(j));
+            added = true;
+        }
+        if (added) cv_.notify_all();
+    }
+
+    void check_cancel_and_budget() {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto& j : jobs_) {
+            if (j->done) continue;
+            std::string c = spool_ + "/cancel/" + j->id;
+            if (fs::exists(c, ec_)) {
+                fs::remove(c, ec_);
+                j->reason = "cancelled";
+                j->done = true;
+            } else if (j->budget > 0 && std::chrono::duration<double>(Clock::now() - j->start).count() >= j->budget) {
+                j->reason = "budget";
+                j->done = true;
+            }
+        }
+    }
+
+    // done 且沒有 worker 還在跑的 job: 確認結果寫完、寫最終狀態、job 檔移到 done/
+    void finish_jobs() {
+        std::vector<std::unique_ptr<Job>> finished;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            for (auto it = jobs_.begin(); it != jobs_.end();) {
+                if ((*it)->done && (*it)->active == 0) {
+                    finished.push_back(std::move(*it));
+                    it = jobs_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (finished.empty()) return;
+        ResultSink::shared().flush();
+        for (auto& j : finished) complete(*j);
+        cv_.notify_all();
+    }
+
+    // 結果已 flush 的 done job: 關掉串流檔的 channel、job 檔移到 done/、寫最終狀態
+    void complete(Job& j) {
+        ResultSink::shared().release(j.stream);
+        fs::rename(job_path("running", j.id), job_path("done", j.id), ec_);
+        write_status(j, "done");
+        double sec = std::chrono::duration<double>(Clock::now() - j.start).count();
+        std::cout << "[Done] " << j.id << " L=" << j.L << " reason=" << j.reason << " found=" << j.found
+                  << " hits=" << j.hits << " best=" << j.best_psl << " (" << sec << " s)" << std::endl;
+    }
+
+    // tmp + rename，讀的人不會看到寫一半的檔
+    void write_status(const Job& j, const char* state) {
+        std::string path = spool_ + "/out/" + j.id + ".status";
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out.is_open()) return;
+            double sec = j.start.time_since_epoch().count() ? std::chrono::duration<double>(Clock::now() - j.start).count() : 0.0;
+            out << "id=" << j.id << "\n"
+                << "state=" << state << "\n"
+                << "L=" << j.L << "\n"
+                << "goal=" << j.goal << "\n"
+                << "found=" << j.found << "\n"
+                << "hits=" << j.hits << "\n"
+                << "best_psl=" << (j.best_psl == 99999 ? -1 : j.best_psl.load()) << "\n"
+                << "workers=" << j.active << "\n"
+                << "elapsed=" << sec << "\n"
+                << "reason=" << j.reason << "\n"
+                << "stream=" << j.stream << "\n"
+                << "results=" << (j.index ? j.index->results : "") << "\n";
+        }
+        fs::rename(tmp, path, ec_);
+    }
+
+    /* ---------- Worker ---------- */
+    // 挑人數最少的 job (同人數取先到的)；呼叫時持有 mu_
+    Job* pick() {
+        Job* best = nullptr;
+        for (auto& j : jobs_) {
+            if (j->done || j->active >= j->cap(threads_)) continue;
+            if (!best || j->active < best->active || (j->active == best->active && j->seq < best->seq)) best = j.get();
+        }
+        return best;
+    }
+
+    // 有別的 job 比自己少 2 個以上 worker (且還能再加人) 時讓出
+    bool should_yield(const Job* self) {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto& j : jobs_) {
+            if (j.get() == self || j->done || j->active >= j->cap(threads_)) continue;
+            if (j->active + 1 < self->active) return true;
+        }
+        return false;
+    }
+
+    void worker(int tid) {
+        std::random_device rd;
+        std::mt19937 seeder(rd() ^ (unsigned)(tid * 2654435761u) ^
+                            (unsigned)std::chrono::system_clock::now().time_since_epoch().count());
+        std::string line;
+        while (true) {
+            Job* j = nullptr;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [&] { return g_stop || (j = pick()) != nullptr; });
+                if (g_stop) return;
+                j->active++;
+            }
+            search(*j, seeder(), line);
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                j->active--;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    void search(Job& j, unsigned seed, std::string& line) {
+        int L = j.L;
+        std::mt19937 rng(seed);
+        Seq A(L), B(L);
+        for (int i = 0; i < L; ++i) A[i] = (rng() & 1) ? 1 : -1;
+        for (int i = 0; i < L; ++i) B[i] = (rng() & 1) ? 1 : -1;
+        if (j.fix_a) {
+            // Legendre: A[i] = (i / L)，i = 0 時取 +1 (同 gen_seeds)
+            for (int i = 0; i < L; ++i) {
+                long long r = 1, b = i % L, e = (L - 1) / 2;
+                while (e > 0) {
+                    if (e & 1) r = r * b % L;
+                    b = b * b % L;
+                    e >>= 1;
+                }
+                A[i] = (i != 0 && r == L - 1) ? -1 : 1;
+            }
+        }
+
+        Anneal::Options opt;
+        opt.target_val = j.target_val;
+        opt.fix_a = j.fix_a;
+        opt.target_count = 0;   // 由 job 的 count / budget 控制結束
+        opt.seed = (unsigned)rng();
+        opt.log = nullptr;
+
+        Anneal::Hooks hooks;
+        LengthIndex* idx = j.index;
+        hooks.found = [&](const Seq& a, const Seq& b, int psl) {
+            uint64_t fp = PacpResults::canonical_fingerprint(a, b);
+            {
+                std::lock_guard<std::mutex> lk(idx->mu);
+                if (!idx->index.remember(fp)) return false;
+            }
+            line.clear();
+            line += std::to_string(L) + "," + std::to_string(psl) + ",";
+            ResultSink::append_pm(line, a);
+            line += ',';
+            ResultSink::append_pm(line, b);
+            line += '\n';
+            ResultSink::shared().submit(j.stream, line);
+            ResultSink::shared().submit(idx->results, line, [idx, fp] { idx->index.commit(fp); },
+                                        { &CanonIndex::sync_hook, &idx->index });
+
+            j.found++;
+            int cur = j.best_psl.load();
+            while (psl < cur && !j.best_psl.compare_exchange_weak(cur, psl)) {}
+            if (psl <= j.goal_psl && ++j.hits >= j.count && j.count > 0 && !j.done) {
+                std::lock_guard<std::mutex> lk(mu_);
+                if (!j.done) {
+                    j.reason = "count";
+                    j.done = true;
+                }
+            }
+            return true;
+        };
+        hooks.stop = [&] { return g_stop || j.done || should_yield(&j); };
+        Anneal::run(A, B, opt, hooks);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::string spool = "./spool";
+    std::string results = "results";
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int poll_ms = 500;
+    bool exit_when_idle = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--spool" && i + 1 < argc) spool = argv[++i];
+        else if (a == "--results" && i + 1 < argc) results = argv[++i];
+        else if (a == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--poll-ms" && i + 1 < argc) poll_ms = std::max(10, std::atoi(argv[++i]));
+        else if (a == "--exit-when-idle") exit_when_idle = true;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--spool DIR] [--results DIR] [--threads N] [--poll-ms MS] [--exit-when-idle]\n";
+            return 1;
+        }
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    Daemon d(spool, results, threads, poll_ms, exit_when_idle);
+    return d.run();
+}
@@ -2,8 +2,13 @@
     PQCP Interactive Analyzer (Fixed)
     Path: src/pqcpcheck.cpp
     Usage: ./bin/pqcpcheck
+           ./bin/pqcpcheck --batch [--format csv|json] [--out FILE] [--summary FILE] [--threads N]
+                           [--zcz-min Z] [--no-header] [--quiet] [FILE|-]...
+      Batch mode checks every pair in the given results files (any text dialect or .pacpr, stdin if none)
+      in parallel and prints one verdict per pair: VICTORY / CLOSE / FAIL.
 */
 
+#include "../lib/pacp_batch.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -137,7 +142,26 @@ void analyze_pair(const std::vector<int>& A, const std::vector<int>& B) {
     std::cout << std::endl;
 }
 
-int main() {
+// --- Batch verdict (same rules as analyze_pair) ---
+// |S(u)| == 2L (mod 4), so PSL == 4 with exactly two nonzero lags means every nonzero lag is 4.
+const char* batch_verdict(const Verify::Profile& p, int /*mid*/) {
+    if (p.psl == 4 && p.peaks == 2) return "VICTORY";
+    if (p.psl <= 4) return "CLOSE";
+    return "FAIL";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::string err;
+        BatchCheck::Options opt;
+        if (std::string(argv[1]) != "--batch" || !BatchCheck::parse_args(argc, argv, 2, opt, err)) {
+            if (!err.empty()) std::cerr << "[Error] " << err << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [" << BatchCheck::usage() << "]" << std::endl;
+            return 1;
+        }
+        return BatchCheck::run(opt, batch_verdict);
+    }
+
     std::string line;
     std::cout << C_WHT << "=== PQCP Interactive Checker ===" << C_RST << std::endl;
     std::cout << "Paste your pair below (Format: ++-+,+--+)" << std::endl;
@@ -0,0 +1,58 @@
+#include "../lib/pacp_results.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// ==========================================
+// resconv: 文字結果檔 <-> 二進位結果檔 (lib/pacp_results.h)
+// ==========================================
+// Usage:
+//   ./bin/resconv to-bin  <in.txt>  <out.pacpr>
+//   ./bin/resconv to-text <in.pacpr> <out.txt>
+//   ./bin/resconv info    <file.pacpr>
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " to-bin <in.txt> <out.pacpr>\n"
+                  << "       " << argv[0] << " to-text <in.pacpr> <out.txt>\n"
+                  << "       " << argv[0] << " info <file.pacpr>\n";
+        return 1;
+    }
+    std::string mode = argv[1];
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    if ((mode == "to-bin" || mode == "to-text") && argc >= 4) {
+        long long n = (mode == "to-bin") ? PacpResults::text_to_binary(argv[2], argv[3])
+                                         : PacpResults::binary_to_text(argv[2], argv[3]);
+        if (n < 0) {
+            std::cerr << "[Error] Cannot convert " << argv[2] << " -> " << argv[3] << "\n";
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+        std::cout << "[Done] " << n << " records: " << argv[2] << " (" << fs::file_size(argv[2]) << " B) -> "
+                  << argv[3] << " (" << fs::file_size(argv[3]) << " B) in " << ms << " ms\n";
+        return 0;
+    }
+
+    if (mode == "info") {
+        PacpResults::Reader rd;
+        if (!rd.open(argv[2])) {
+            std::cerr << "[Error] Not a binary result file: " << argv[2] << "\n";
+            return 1;
+        }
+        std::map<std::pair<int, int>, long long> by_goal;   // (goal, L) -> count
+        size_t n = rd.for_each([&](const PacpResults::RecordView& v) { by_goal[{ v.h->goal, v.h->L }]++; });
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+        std::cout << argv[2] << ": " << n << " records, " << rd.size_bytes() << " B, scanned in " << ms << " ms\n";
+        for (const auto& kv : by_goal)
+            std::cout << "  Goal " << kv.first.first << " | L=" << kv.first.second << " | " << kv.second << "\n";
+        return 0;
+    }
+
+    std::cerr << "[Error] Unknown mode: " << mode << "\n";
+    return 1;
+}
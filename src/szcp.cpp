@@ -1,3 +1,4 @@
+#include "../lib/pacp_verify.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -10,29 +11,31 @@
 namespace fs = std::filesystem;
 using namespace std;
 
-// 計算週期自相關函數 (Periodic ACF)
-int calc_pacf(const string& s, int u, int L) {
-    int sum = 0;
-    for (int i = 0; i < L; ++i) {
-        int val_i = (s[i] == '+') ? 1 : -1;
-        int val_iu = (s[(i + u) % L] == '+') ? 1 : -1;
-        sum += val_i * val_iu;
-    }
-    return sum;
+// [New] 週期 ACF 改用 lib/pacp_verify.h 的 packed kernel: 每筆 pair 只算一次 S(u) = rho_A(u) + rho_B(u)，
+//       不再逐個 lag 重新從字串計算 (所有類別一次分完請用 bin/classify)
+static bool pack_string(const string& s, int L, vector<uint64_t>& w) {
+    if ((int)s.size() != L) return false;
+    w.assign(PacpResults::words_for(L), 0);
+    for (int i = 0; i < L; ++i) if (s[i] != '+') w[i >> 6] |= (1ULL << (i & 63));
+    return true;
 }
 
 // 驗證是否符合 Optimal (L, L/2)-SZCP 定義
 // 條件 1: ZCZ 寬度 Z = L/2 (u=1 到 L/2-1 之和必須為 0)
 // 條件 2: Out-of-zone magnitude 等於 2 (u=L/2 之和絕對值必須為 2)
 bool is_optimal_szcp(const string& sA, const string& sB, int L) {
+    static thread_local Verify::Kernel kernel;
+    static thread_local vector<uint64_t> a, b;
+    static thread_local vector<int> sum;
+    if (L < 2 || !pack_string(sA, L, a) || !pack_string(sB, L, b)) return false;
     int Z = L / 2;
+    kernel.pair_acf(a.data(), b.data(), L, sum);
     // 條件 1: 區域內 ZCZ 檢測
     for (int u = 1; u < Z; ++u) {
-        if ((calc_pacf(sA, u, L) + calc_pacf(sB, u, L)) != 0) return false;
+        if (sum[u] != 0) return false;
     }
     // 條件 2: 區域外 Magnitude 檢測
-    int out_zone_val = abs(calc_pacf(sA, Z, L) + calc_pacf(sB, Z, L));
-    return (out_zone_val == 2);
+    return abs(sum[Z]) == 2;
 }
 
 int main() {
@@ -0,0 +1,109 @@
+#!/bin/bash
+
+# ============================================================
+# pacpd Job Submitter
+# Usage: ./submit.sh <Start_L> <End_L> <Count> <Budget_sec> [--spool DIR] [--threads N] [--wait]
+#   - 與 batch_run.sh 相同的參數與奇偶規則，但不開新行程: 每個 L 寫成一個 job 丟進 pacpd 的 spool
+#       Start=Odd,  End=Odd  -> ODD_ONLY  (只送奇數)
+#       Start=Even, End=Even -> EVEN_ONLY (只送偶數)
+#       混合奇偶             -> MIXED     (全部)
+#   - 偶數 L 只送 Goal 2 白名單內的 (其他偶數 pacpd 也會拒收)
+#   - --wait: 等所有 job 結束，過程中把找到的結果即時印出來 (out/<id>.txt)
+# 先啟動 daemon:  ./bin/pacpd --threads 8 &
+# ============================================================
+
+if [ "$#" -lt 4 ]; then
+    echo "Usage: ./submit.sh <Start_L> <End_L> <Count> <Budget_sec> [--spool DIR] [--threads N] [--wait]"
+    echo "Example: ./submit.sh 29 45 10 600 --wait   (29, 31, ..., 45: Odd Only)"
+    echo "         ./submit.sh 28 32 10 600          (28, 30: Even Only, Goal 2 list)"
+    echo "         ./submit.sh 28 33 10 600          (28..33: All)"
+    exit 1
+fi
+
+START_L=$1
+END_L=$2
+COUNT=$3
+BUDGET=$4
+shift 4
+
+SPOOL="./spool"
+THREADS=0
+WAIT=0
+while [ "$#" -gt 0 ]; do
+    case "$1" in
+        --spool) SPOOL=$2; shift 2 ;;
+        --threads) THREADS=$2; shift 2 ;;
+        --wait) WAIT=1; shift ;;
+        *) echo "[Error] Unknown option: $1"; exit 1 ;;
+    esac
+done
+
+if [ "$START_L" -gt "$END_L" ]; then
+    echo "[Error] Start_L ($START_L) cannot be greater than End_L ($END_L)."
+    exit 1
+fi
+
+# 執行模式 (與 batch_run.sh 相同)
+if [ $((START_L % 2)) -ne 0 ] && [ $((END_L % 2)) -ne 0 ]; then
+    BATCH_MODE="ODD_ONLY"
+elif [ $((START_L % 2)) -eq 0 ] && [ $((END_L % 2)) -eq 0 ]; then
+    BATCH_MODE="EVEN_ONLY"
+else
+    BATCH_MODE="MIXED"
+fi
+echo "[Submit] Range ${START_L} -> ${END_L} | Mode: ${BATCH_MODE}"
+
+# Goal 2 白名單 (必須與 run.sh / batch_run.sh / src/pacpd.cpp 一致)
+GOAL2_LIST=" 6 12 14 22 24 28 30 38 42 48 54 56 60 62 66 70 76 78 84 88 92 96 102 108 114 118 120 124 126 132 134 138 142 150 158 166 168 172 176 182 192 198 "
+
+mkdir -p "${SPOOL}/incoming"
+STAMP=$(date +%Y%m%d_%H%M%S)
+IDS=()
+
+for ((L=START_L; L<=END_L; L++)); do
+    if [ $((L % 2)) -ne 0 ]; then
+        [ "$BATCH_MODE" == "EVEN_ONLY" ] && continue
+    else
+        [ "$BATCH_MODE" == "ODD_ONLY" ] && continue
+        [[ ! "$GOAL2_LIST" =~ " $L " ]] && continue
+    fi
+    ID="L${L}_${STAMP}_$$"
+    # 先寫 '.' 開頭的暫存檔再 mv，daemon 不會讀到寫一半的 job
+    TMP="${SPOOL}/incoming/.${ID}.job"
+    echo "L=${L} count=${COUNT} budget=${BUDGET} threads=${THREADS}" > "$TMP"
+    mv "$TMP" "${SPOOL}/incoming/${ID}.job"
+    IDS+=("$ID")
+    echo "[Submit] ${ID}"
+done
+
+[ "$WAIT" -eq 0 ] && exit 0
+[ "${#IDS[@]}" -eq 0 ] && exit 0
+
+declare -A PRINTED
+while true; do
+    PENDING=0
+    for ID in "${IDS[@]}"; do
+        STREAM="${SPOOL}/out/${ID}.txt"
+        if [ -f "$STREAM" ]; then
+            N=${PRINTED[$ID]:-0}
+            TOTAL=$(wc -l < "$STREAM")
+            if [ "$TOTAL" -gt "$N" ]; then
+                tail -n +$((N + 1)) "$STREAM" | head -n $((TOTAL - N))
+                PRINTED[$ID]=$TOTAL
+            fi
+        fi
+        STATE=$(grep -s '^state=' "${SPOOL}/out/${ID}.status" | cut -d= -f2)
+        if [ "$STATE" != "done" ] && [ "$STATE" != "failed" ]; then
+            PENDING=$((PENDING + 1))
+        fi
+    done
+    [ "$PENDING" -eq 0 ] && break
+    sleep 1
+done
+
+echo "========================================================"
+for ID in "${IDS[@]}"; do
+    S="${SPOOL}/out/${ID}.status"
+    echo " ${ID}: $(grep -s -E '^(state|reason|found|hits|best_psl|elapsed)=' "$S" | tr '\n' ' ')"
+done
+echo "========================================================"